@@ -0,0 +1,20 @@
+#ifndef CHIRC_BUFFER_POOL_H
+#define CHIRC_BUFFER_POOL_H
+
+// Connections borrow their I/O buffers only while data is in flight (a line
+// not complete yet, replies not sent yet) and give them back right after, so
+// an idle connection holds no buffer at all. Returned buffers are kept on a
+// free list, up to max_free of them, to be lent again without malloc.
+typedef struct BufferPool{
+    int buffer_size;
+    int max_free;
+    int num_free;
+    void *free_list;
+} BufferPool;
+
+#define BUFFER_POOL(size, max_free) {size, max_free, 0, NULL}
+
+char *borrow_buffer(BufferPool *pool);
+void return_buffer(BufferPool *pool, char *buffer);
+
+#endif //CHIRC_BUFFER_POOL_H
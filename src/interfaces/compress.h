@@ -0,0 +1,33 @@
+#ifndef CHIRC_COMPRESS_H
+#define CHIRC_COMPRESS_H
+
+#define COMPRESS_LEVEL 6
+#define MAX_FREE_COMPRESSORS 4
+#define COMPRESS_IDLE_TIMEOUT_MS 30000
+
+// Opt-in compression of what the server sends to a client, asked for with a
+// 'Z' in the flags (after the '|') or options of PASS. The stream is raw
+// deflate (RFC 1951, the client reads it with inflateInit2(-15)) and starts with
+// the reply to the registration. Only this direction is compressed: what the
+// client sends is never inflated, and there are no server links to negotiate
+// compression for yet.
+// A connection keeps its compressor, and so its history, from one reply to the
+// next; every reply ends with a sync flush, so it reaches the client whole and
+// the stream is byte aligned. After COMPRESS_IDLE_TIMEOUT_MS with no input the
+// compressor is reset and goes back to a shared pool, so connections idle for
+// long hold no compressor memory: the next one they borrow starts from an empty
+// history, which the client's inflater reads on as the same stream.
+typedef struct Compressor Compressor;
+
+typedef enum {
+    COMPRESS_MORE,  // more output follows at once: nothing has to leave yet
+    COMPRESS_SYNC   // everything so far must reach the client, the history is kept
+} compress_flush;
+
+int compression_requested(const char *pass_param);
+Compressor *borrow_compressor();
+void return_compressor(Compressor *compressor);
+const char *compress_output(Compressor *compressor, const char *data, int len,
+                            compress_flush flush, int *compressed_len);
+
+#endif //CHIRC_COMPRESS_H
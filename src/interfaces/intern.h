@@ -0,0 +1,20 @@
+#ifndef CHIRC_INTERN_H
+#define CHIRC_INTERN_H
+
+// Identity strings (nicks, usernames, hosts) are stored once in a pool. Each
+// entry keeps its RFC 1459 case folded form ({}|~ are the lower case of []\^)
+// and the hash of it, so that two strings are the same one if they are the
+// same pointer, and equal ignoring case if hash and folded form match.
+typedef struct InternedString{
+    char *string;
+    char *folded;
+    unsigned int hash;
+    int refcount;
+    struct InternedString *next; // next in the same bucket
+} InternedString;
+
+InternedString *intern_string(const char *string);
+void release_string(InternedString *interned);
+int interned_equal_nocase(InternedString *a, InternedString *b);
+
+#endif //CHIRC_INTERN_H
@@ -0,0 +1,14 @@
+#ifndef CHIRC_MEMORY_H
+#define CHIRC_MEMORY_H
+
+#include <stddef.h>
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// Memory for the big pools (e.g. the string pool buckets). From HUGE_PAGE_SIZE
+// up it is mapped aligned to huge pages and marked for transparent huge pages,
+// so that walking it at 100k+ users does not keep missing the TLB.
+void *alloc_pool_memory(size_t size);
+void free_pool_memory(void *memory, size_t size);
+
+#endif //CHIRC_MEMORY_H
@@ -0,0 +1,24 @@
+#ifndef CHIRC_MOTD_H
+#define CHIRC_MOTD_H
+
+#include <interfaces/output.h>
+
+#define MOTD_FILE "motd.txt"
+
+// The MOTD is read once and kept already formatted: body holds every line as
+// " :- <line>\r\n" so that sending it only needs the 372 prefix and the nick.
+// It is read again when the file changes (inode, mtime or size, checked with a
+// stat() when the MOTD is needed) or on SIGHUP. Reloads only happen in
+// get_motd(), never while a MOTD is being sent, so the old one is freed at once.
+typedef struct Motd{
+    int num_lines;
+    int *line_offsets; // num_lines + 1 offsets in body
+    char *body;
+} Motd;
+
+int load_motd(const char *file_name);
+void install_motd_reload_handler();
+Motd *get_motd();
+void append_motd(Output *out, const char *nick);
+
+#endif //CHIRC_MOTD_H
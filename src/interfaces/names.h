@@ -0,0 +1,19 @@
+#ifndef CHIRC_NAMES_H
+#define CHIRC_NAMES_H
+
+#include <interfaces/output.h>
+#include <interfaces/user.h>
+
+// NAMES replies are generated lazily: the cursor remembers the next user to
+// list and emit_names() only writes while the output buffer has room for a
+// whole reply. The caller flushes and calls it again until it returns 0, so
+// the full reply set is never held in memory at once.
+typedef struct NamesCursor{
+    User *next_user;
+    int done;
+} NamesCursor;
+
+void start_names_cursor(NamesCursor *cursor, User *p_user_head);
+int emit_names(NamesCursor *cursor, Output *out, const char *nick);
+
+#endif //CHIRC_NAMES_H
@@ -0,0 +1,37 @@
+#ifndef CHIRC_OUTPUT_H
+#define CHIRC_OUTPUT_H
+
+#define OUTPUT_BUFFER_SIZE 4096
+#define MAX_MSG_LEN 512 // an IRC message (CRLF included) is never longer than this
+
+struct Compressor;
+
+// per connection output buffer: replies are written here and sent with a single flush.
+// The buffer is borrowed from a pool by the first reply and given back by the
+// flush at the end of the iteration.
+typedef struct Output{
+    int socket_fd;
+    unsigned long connection_id;
+    int len;
+    int corked;
+    int compressed; // negotiated at registration, see compress.h
+    struct Compressor *compressor; // only while the connection is active
+    char *buffer;
+} Output;
+
+// Flush policy: client sockets have TCP_NODELAY, so the replies to a command
+// leave in one segment as soon as they are flushed. Only when a burst does not
+// fit the buffer (MOTD, NAMES) the socket gets corked, so that the kernel
+// sends full segments, and it is uncorked by the flush at the end of the
+// event loop iteration.
+void set_socket_buffer_sizes(int listen_fd, int send_size, int receive_size);
+void configure_client_socket(int socket_fd);
+void init_output(Output *out, int socket_fd, unsigned long connection_id);
+char *reserve_output(Output *out, int needed);
+void commit_output(Output *out, int len);
+void flush_output_in_burst(Output *out);
+void flush_output(Output *out);
+int wait_for_input(Output *out);
+void close_output(Output *out);
+
+#endif //CHIRC_OUTPUT_H
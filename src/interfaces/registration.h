@@ -0,0 +1,30 @@
+#ifndef CHIRC_REGISTRATION_H
+#define CHIRC_REGISTRATION_H
+
+#include <interfaces/intern.h>
+
+// Per connection registration state machine. PASS, NICK and USER may come in
+// any order, in one packet or interleaved with other commands: each one only
+// fills its field, and the connection is registered as soon as both the nick
+// and the username are known.
+typedef enum {
+    REG_WAITING,    // nothing useful got yet
+    REG_GOT_NICK,
+    REG_GOT_USER,
+    REG_REGISTERED
+} registration_state;
+
+typedef struct Registration{
+    registration_state state;
+    int got_pass;
+    int compress;   // PASS asked for a compressed stream
+    InternedString *nick_name;
+    InternedString *user_name;
+} Registration;
+
+void init_registration(Registration *registration);
+registration_state set_registration_nick(Registration *registration, const char *nick_name);
+registration_state set_registration_user(Registration *registration, const char *user_name);
+void clear_registration(Registration *registration);
+
+#endif //CHIRC_REGISTRATION_H
@@ -0,0 +1,38 @@
+#ifndef CHIRC_REPLIES_H
+#define CHIRC_REPLIES_H
+
+#include <interfaces/output.h>
+
+#define CHIRC_VERSION "chirc-0.1"
+
+// the numeric replies we know how to build (codes are in reply.h)
+typedef enum {
+    TPL_WELCOME,
+    TPL_YOURHOST,
+    TPL_CREATED,
+    TPL_MYINFO,
+    TPL_LUSERCLIENT,
+    TPL_LUSEROP,
+    TPL_LUSERUNKNOWN,
+    TPL_LUSERCHANNELS,
+    TPL_LUSERME,
+    TPL_MOTDSTART,
+    TPL_MOTD,
+    TPL_ENDOFMOTD,
+    TPL_NOMOTD,
+    TPL_NAMREPLY,
+    TPL_ENDOFNAMES,
+    TPL_LISTEND,
+    TPL_NOTREGISTERED,
+    TPL_NONICKNAMEGIVEN,
+    TPL_ERRONEUSNICKNAME,
+    TPL_NEEDMOREPARAMS,
+    TPL_ALREADYREGISTRED,
+    NUM_REPLY_TEMPLATES
+} reply_template_id;
+
+void init_reply_templates(const char *servername);
+void append_reply(Output *out, reply_template_id id, const char *nick, ...);
+const char *reply_prefix(reply_template_id id, int *prefix_len);
+
+#endif //CHIRC_REPLIES_H
@@ -0,0 +1,32 @@
+#ifndef CHIRC_RESOLVER_H
+#define CHIRC_RESOLVER_H
+
+#include <sys/socket.h>
+
+#define MAX_HOST_LEN 256
+#define RESOLVER_THREADS 2
+#define RESOLVER_TIMEOUT_MS 200
+#define RESOLVER_CACHE_SIZE 1024
+#define RESOLVER_CACHE_TTL 300 // seconds
+#define RESOLVER_FAILED_TTL 60 // for addresses with no (confirmed) name
+
+// Hostnames of the clients are looked up by a pool of resolver threads while
+// the connection goes on registering, so the event loop never blocks on DNS.
+// A name is only used if it resolves back to the client address. Answers are
+// kept in a bounded cache for RESOLVER_CACHE_TTL seconds, failures (the
+// numeric address is used) for RESOLVER_FAILED_TTL.
+typedef struct HostLookup{
+    struct sockaddr_storage address;
+    socklen_t address_len;
+    char host[MAX_HOST_LEN]; // the numeric address until the name is resolved
+    int done;
+    int refcount;
+    struct HostLookup *next_pending;
+} HostLookup;
+
+void start_resolver(int num_threads);
+HostLookup *resolve_host_async(const struct sockaddr *address, socklen_t address_len);
+void wait_for_host(HostLookup *lookup, int timeout_ms, char *host);
+void release_host_lookup(HostLookup *lookup);
+
+#endif //CHIRC_RESOLVER_H
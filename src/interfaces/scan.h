@@ -0,0 +1,25 @@
+#ifndef CHIRC_SCAN_H
+#define CHIRC_SCAN_H
+
+// Byte scanning kernels used on every received message. Each one has a
+// scalar version and, on x86, SSE2 and (where it pays off) AVX2 ones. The
+// pointers below start on the scalar versions and init_scan_kernels() moves
+// them to the widest ones the CPU supports.
+typedef enum {
+    SCAN_SCALAR,
+    SCAN_SSE2,
+    SCAN_AVX2
+} scan_level;
+
+// index of the first `byte` in s, len if there is none
+extern int (*scan_for_byte)(const char *s, int len, char byte);
+// RFC 1459 lower case: A-Z[\]^ become a-z{|}~
+extern void (*fold_irc_case)(char *dst, const char *src, int len);
+// only letters, digits, []\`_^{|} and '-', not starting with a digit or '-'
+extern int (*is_valid_nick)(const char *nick, int len);
+// starts with '#' or '&', no NUL, BEL, CR, LF, space, comma or colon
+extern int (*is_valid_channel_name)(const char *name, int len);
+
+scan_level init_scan_kernels(scan_level max_level);
+
+#endif //CHIRC_SCAN_H
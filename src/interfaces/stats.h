@@ -0,0 +1,22 @@
+#ifndef CHIRC_STATS_H
+#define CHIRC_STATS_H
+
+// aggregates needed by LUSERS (and WHOIS). They are kept up to date on every
+// connection/registration/quit event so that replying costs O(1) instead of
+// walking the users list. operators and channels stay 0 until OPER and JOIN exist.
+typedef struct ServerStats{
+    int users;      // registered users
+    int operators;  // users that got the operator mode
+    int unknown;    // connections that did not register yet
+    int channels;   // channels currently formed
+    int clients;    // registered clients connected to this server
+    int servers;    // servers in the network (this one included)
+} ServerStats;
+
+extern ServerStats server_stats;
+
+void stats_connection_opened();
+void stats_connection_registered();
+void stats_connection_closed(int was_registered);
+
+#endif //CHIRC_STATS_H
@@ -0,0 +1,46 @@
+#ifndef CHIRC_TRACE_H
+#define CHIRC_TRACE_H
+
+// Static tracepoints (USDT, provider "chirc") on the hot paths, to measure
+// chirc in production with perf or bpftrace, e.g.
+//     bpftrace -e 'usdt:./chirc:chirc:command_completed { @[arg1] = count(); }'
+// With sys/sdt.h each one is a single nop until a tracer attaches; without it
+// they compile to nothing.
+//
+//     connection_accept   (connection id, socket fd)
+//     connection_close    (connection id, socket fd)
+//     line_framed         (connection id, bytes)
+//     command_dispatched  (connection id, command_id)
+//     command_completed   (connection id, command_id)
+//     message_enqueued    (connection id, bytes)
+//     message_flushed     (connection id, bytes)
+//     server_relay        (connection id, bytes) -- for the server links
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define CHIRC_HAVE_SDT
+#endif
+#endif
+
+#ifdef CHIRC_HAVE_SDT
+#define TRACE_CONNECTION_ACCEPT(id, fd)     DTRACE_PROBE2(chirc, connection_accept, id, fd)
+#define TRACE_CONNECTION_CLOSE(id, fd)      DTRACE_PROBE2(chirc, connection_close, id, fd)
+#define TRACE_LINE_FRAMED(id, bytes)        DTRACE_PROBE2(chirc, line_framed, id, bytes)
+#define TRACE_COMMAND_DISPATCHED(id, cmd)   DTRACE_PROBE2(chirc, command_dispatched, id, cmd)
+#define TRACE_COMMAND_COMPLETED(id, cmd)    DTRACE_PROBE2(chirc, command_completed, id, cmd)
+#define TRACE_MESSAGE_ENQUEUED(id, bytes)   DTRACE_PROBE2(chirc, message_enqueued, id, bytes)
+#define TRACE_MESSAGE_FLUSHED(id, bytes)    DTRACE_PROBE2(chirc, message_flushed, id, bytes)
+#define TRACE_SERVER_RELAY(id, bytes)       DTRACE_PROBE2(chirc, server_relay, id, bytes)
+#else
+#define TRACE_CONNECTION_ACCEPT(id, fd)     do {} while (0)
+#define TRACE_CONNECTION_CLOSE(id, fd)      do {} while (0)
+#define TRACE_LINE_FRAMED(id, bytes)        do {} while (0)
+#define TRACE_COMMAND_DISPATCHED(id, cmd)   do {} while (0)
+#define TRACE_COMMAND_COMPLETED(id, cmd)    do {} while (0)
+#define TRACE_MESSAGE_ENQUEUED(id, bytes)   do {} while (0)
+#define TRACE_MESSAGE_FLUSHED(id, bytes)    do {} while (0)
+#define TRACE_SERVER_RELAY(id, bytes)       do {} while (0)
+#endif
+
+#endif //CHIRC_TRACE_H
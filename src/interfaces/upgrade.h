@@ -0,0 +1,26 @@
+#ifndef CHIRC_UPGRADE_H
+#define CHIRC_UPGRADE_H
+
+#include <interfaces/user.h>
+#include <interfaces/registration.h>
+
+#define UPGRADE_LINE_LEN 512
+
+// Everything a new binary needs to take over from the running one without the
+// clients noticing: the listening socket, the connected client (if any) with
+// its registration (and user), and the half received message.
+typedef struct UpgradeState{
+    int listen_fd;
+    int client_fd; // -1 if no client is connected
+    Registration registration;
+    int line_len;
+    char line[UPGRADE_LINE_LEN];
+    char last_read_char;
+} UpgradeState;
+
+void install_upgrade_handler();
+int upgrade_was_requested();
+void hand_off_to_new_binary(char *argv[], UpgradeState *state, User *p_user_head);
+int resume_from_old_binary(int channel_fd, UpgradeState *state, User *p_user_head);
+
+#endif //CHIRC_UPGRADE_H
@@ -5,18 +5,24 @@
 #ifndef CHIRC_USER_H
 #define CHIRC_USER_H
 
+#include <interfaces/intern.h>
+
 typedef struct User{
     int socket_fd;
-    char *nick_name;
-    char *user_name;
-    char *email;
+    InternedString *nick_name;
+    InternedString *user_name;
+    InternedString *email;
+    InternedString *host_name;
     struct User *next;
 
 }User;
 
 
-User create_new_user(int socket_fd, User *p_user_head, char *nick_name, char *user_name);
+User create_new_user(int socket_fd, User *p_user_head, const char *nick_name, const char *user_name,
+                     const char *host_name);
 void print_all_nicknames(User* p_head);
 User *remove_user_by_nickname(User* p_user_head, char *n_name_to_remove);
+User *find_user_by_socket(User *p_user_head, int socket_fd);
+void remove_user_by_socket(User *p_user_head, int socket_fd);
 
 #endif //CHIRC_USER_H
@@ -3,13 +3,27 @@
 #define CHIRC_UTILS_H
 #define MAX_NUM_OF_PARAMS_FOR_CMD 15
 
+// the commands the server knows about (also what the tracepoints report)
+typedef enum {
+    CMD_UNKNOWN,
+    CMD_PASS,
+    CMD_NICK,
+    CMD_USER,
+    CMD_LUSERS,
+    CMD_MOTD,
+    CMD_NAMES,
+    CMD_LIST,
+    CMD_PRIVMSG,    // recognised (451 before registration) but not implemented yet
+    CMD_NOTICE
+} command_id;
 
+// a parsed message: the strings point into the line it was parsed from,
+// so it is only valid as long as that line is
 typedef struct Command{
-    char cmd_string[100];
-    char args[MAX_NUM_OF_PARAMS_FOR_CMD][100];
-    int has_a_linked_command;
-    struct Command *linked_command; // like NICK and USER are linked command because they are expected to be received together
-    int cmd_filled_with_info;
+    char *cmd_string;
+    command_id id;
+    int num_args;
+    char *args[MAX_NUM_OF_PARAMS_FOR_CMD];
 } Command;
 
 #endif //CHIRC_UTILS_H
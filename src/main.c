@@ -39,10 +39,12 @@
  *
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
 
 #include "log.h"
 #include <netdb.h>
@@ -53,14 +55,33 @@
 #include <fcntl.h>
 #include <asm/errno.h>
 #include <errno.h>
+#include <sched.h>
 
 #include <interfaces/utils.h>
 #include <reply.h>
 #include <interfaces/user.h>
+#include <interfaces/stats.h>
+#include <interfaces/output.h>
+#include <interfaces/replies.h>
+#include <interfaces/motd.h>
+#include <interfaces/names.h>
+#include <interfaces/upgrade.h>
+#include <interfaces/scan.h>
+#include <interfaces/resolver.h>
+#include <interfaces/buffer_pool.h>
+#include <interfaces/trace.h>
+#include <interfaces/registration.h>
+#include <interfaces/compress.h>
 
 
 #define MAX_NICK_NAME_NUM 100
-#define MAX_NICK_NAME_LEN 10
+#define MAX_NICK_NAME_LEN 30 // longer nicks are refused with 432, so replies carrying one always fit
+#define MAX_LINE_LEN 512
+
+// line buffers are only held by connections that got part of a message
+static BufferPool line_pool = BUFFER_POOL(MAX_LINE_LEN, 64);
+
+static char server_created[64]; // for RPL_CREATED, set at startup
 
 
 
@@ -69,28 +90,39 @@ void error(char *msg) {
     exit(1);
 }
 
+void pin_to_cpu(int cpu){
+    // keeps the server on one core: its users and pools stay in that core's
+    // caches and, being first touched there, in its NUMA node's memory
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) < 0) error("ERROR pinning to the requested CPU");
+}
+
 // to export these
-void parse_msg_for_cmd_and_args(const char *input_baffer, char cmd_and_args[100][100]);
-void create_new_user_with_the_data_got(int new_sock_fd, User *user_db, char *n_name, char *u_name);
-void process_the_command(int socket, User *user_db, Command);
-Command build_the_command(char cmd_and_args[100][100]);
-int are_linked_commands(Command first_command, Command second_command);
+Command parse_the_command(char *line);
+int process_the_command(Output *out, User *user_db, Command *cmd_info, Registration *registration, HostLookup *host_lookup);
+void process_registered_user_command(Output *out, User *user_db, Command *cmd_info, Registration *registration);
+command_id get_command_id(const char *cmd_string);
 
 
 
-void send_message_to_client(char *buffer, int socket_fd){
-    int n;
-    n = send(socket_fd, buffer, 256, 0);
-    chilog(INFO,"Sent to socket: %s\n",buffer);
-    if (n < 0) error("ERROR writing to socket");
+void send_greetings(Output *out, User input_user){
+    char *nick = input_user.nick_name->string;
+    append_reply(out, TPL_WELCOME, nick, nick, input_user.user_name->string, input_user.host_name->string);
+    append_reply(out, TPL_YOURHOST, nick);
+    append_reply(out, TPL_CREATED, nick, server_created);
+    append_reply(out, TPL_MYINFO, nick);
 }
 
-void send_greetings(int socket_fd, User input_user){
-    char buffer[256];
-    bzero(buffer,256);
-    sprintf(buffer, ":circ.groucho.com %s %s :Welcome to the Internet Relay Network %s!%s@user.example.com \r\n",
-            RPL_WELCOME, input_user.nick_name, input_user.nick_name, input_user.user_name);
-    send_message_to_client(buffer, socket_fd);
+void send_lusers(Output *out, User input_user){
+    // all the numbers come from the maintained counters: no walk over the users
+    char *nick = input_user.nick_name->string;
+    append_reply(out, TPL_LUSERCLIENT, nick, server_stats.users, server_stats.servers);
+    append_reply(out, TPL_LUSEROP, nick, server_stats.operators);
+    append_reply(out, TPL_LUSERUNKNOWN, nick, server_stats.unknown);
+    append_reply(out, TPL_LUSERCHANNELS, nick, server_stats.channels);
+    append_reply(out, TPL_LUSERME, nick, server_stats.clients, server_stats.servers);
 }
 
 
@@ -99,8 +131,11 @@ int main(int argc, char *argv[])
     int opt;
     char *port = NULL, *passwd = NULL, *servername = NULL, *network_file = NULL;
     int verbosity = 0;
+    int upgrade_fd = -1;
+    int cpu = -1;
+    int send_buffer_size = 0, receive_buffer_size = 0;
 
-    while ((opt = getopt(argc, argv, "p:o:s:n:vqh")) != -1)
+    while ((opt = getopt(argc, argv, "p:o:s:n:a:b:r:vqhU:")) != -1)
         switch (opt)
         {
         case 'p':
@@ -120,14 +155,27 @@ int main(int argc, char *argv[])
             }
             network_file = strdup(optarg);
             break;
+        case 'a':
+            cpu = atoi(optarg);
+            break;
+        case 'b':
+            send_buffer_size = atoi(optarg);
+            break;
+        case 'r':
+            receive_buffer_size = atoi(optarg);
+            break;
         case 'v':
             verbosity++;
             break;
         case 'q':
             verbosity = -1;
             break;
+        case 'U':
+            // not for users: added by a running chirc when it hands off to a new binary
+            upgrade_fd = atoi(optarg);
+            break;
         case 'h':
-            printf("Usage: chirc -o OPER_PASSWD [-p PORT] [-s SERVERNAME] [-n NETWORK_FILE] [(-q|-v|-vv)]\n");
+            printf("Usage: chirc -o OPER_PASSWD [-p PORT] [-s SERVERNAME] [-n NETWORK_FILE] [-a CPU] [-b SNDBUF] [-r RCVBUF] [(-q|-v|-vv)]\n");
             exit(0);
             break;
         default:
@@ -173,6 +221,17 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
+    if (cpu >= 0) pin_to_cpu(cpu);
+    init_scan_kernels(SCAN_AVX2);
+    start_resolver(RESOLVER_THREADS);
+
+    time_t now = time(NULL);
+    strftime(server_created, sizeof(server_created), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    init_reply_templates(servername ? servername : "circ.groucho.com");
+    load_motd(MOTD_FILE);
+    install_motd_reload_handler();
+    install_upgrade_handler();
+
     int n;
     char buffer[256];
     struct addrinfo hints, *res;
@@ -195,37 +254,61 @@ int main(int argc, char *argv[])
         error("Error in retrieving information of the host");
     }
 
+    User *p_user_head = (User *) malloc(sizeof(User));
+    bzero(p_user_head, sizeof(User));
+    unsigned long num_connections = 0; // also gives each connection its id for the tracepoints
+
     // TODO create error wrappers for the following procedures
     int socket_fd;
-    socket_fd = socket(res->ai_family, res->ai_socktype, res -> ai_protocol);
-
-    bind(socket_fd, res->ai_addr, res->ai_addrlen);
-    int queue = 5; // clients allowed to queue
-    listen(socket_fd, queue);
+    UpgradeState upgrade_state;
+    upgrade_state.client_fd = -1;
+    if (upgrade_fd >= 0){
+        // an old chirc is handing its sockets and state off to us
+        if (!resume_from_old_binary(upgrade_fd, &upgrade_state, p_user_head))
+            error("ERROR resuming from the previous binary");
+        socket_fd = upgrade_state.listen_fd;
+    } else{
+        socket_fd = socket(res->ai_family, res->ai_socktype, res -> ai_protocol);
+
+        bind(socket_fd, res->ai_addr, res->ai_addrlen);
+        set_socket_buffer_sizes(socket_fd, send_buffer_size, receive_buffer_size);
+        int queue = 5; // clients allowed to queue
+        listen(socket_fd, queue);
+    }
     struct sockaddr_storage client_sock_addr;
     int client_len = sizeof(client_sock_addr); // the space needed that will change accordingly
 
-    User *p_user_head = (User *) malloc(sizeof(User));
-    bzero(p_user_head, sizeof(User));
-
-
 
     while (1) {
         int new_sock_fd;
-        new_sock_fd = accept(socket_fd, (struct sockaddr *) &client_sock_addr, (socklen_t *) &client_len);
-
-        if (new_sock_fd < 0)
-            error("ERROR on accept");
-
-        char n_name[MAX_NICK_NAME_LEN + 1];
-        bzero(n_name, MAX_NICK_NAME_LEN + 1);
+        int resuming = upgrade_state.client_fd >= 0;
+        if (resuming){
+            new_sock_fd = upgrade_state.client_fd;
+            upgrade_state.client_fd = -1;
+        } else{
+            if (upgrade_was_requested()){
+                upgrade_state.listen_fd = socket_fd;
+                hand_off_to_new_binary(argv, &upgrade_state, p_user_head);
+            }
+            new_sock_fd = accept(socket_fd, (struct sockaddr *) &client_sock_addr, (socklen_t *) &client_len);
 
-        int nickname_was_sent = 0;
+            if (new_sock_fd < 0 && errno == EINTR) continue;
+            if (new_sock_fd < 0)
+                error("ERROR on accept");
+            stats_connection_opened();
+            configure_client_socket(new_sock_fd);
+        }
+        Registration registration;
+        init_registration(&registration);
+        Output output;
+        init_output(&output, new_sock_fd, ++num_connections);
+        TRACE_CONNECTION_ACCEPT(output.connection_id, new_sock_fd);
+        // the hostname is looked up while the client registers (getpeername
+        // because a connection resumed after an upgrade did not go through accept)
+        socklen_t peer_len = sizeof(client_sock_addr);
+        getpeername(new_sock_fd, (struct sockaddr *) &client_sock_addr, &peer_len);
+        HostLookup *host_lookup = resolve_host_async((struct sockaddr *) &client_sock_addr, peer_len);
 
-        char words_received[100][100];
-        char cmd_and_args_array[1+MAX_NUM_OF_PARAMS_FOR_CMD][100]; // the first element stores the command, while the others the arguments
-        int count_words = 0;
-        int count_commands = 0;
        // n = receive(new_sock_fd, buffer, 255, 0);
 
 
@@ -233,18 +316,38 @@ int main(int argc, char *argv[])
         char current_read_char = 0;
         char last_read_char = 0;
 
-        // TODO understand
-        char *buffer_with_cmd_and_args = (char *) malloc(512);
-//        char buffer_with_cmd_and_args[512];
+        // borrowed from line_pool when a message starts, given back when it is complete
+        char *buffer_with_cmd_and_args = NULL;
         int num_chars_got = 0;
-        Command received_cmd = {};
-        Command previous_cmd = {};
-        bzero(&previous_cmd, sizeof(previous_cmd));
-        int command_can_be_processed = 0;
+        Command received_cmd;
         //char *buffer = (char *) malloc(256);
         // TODO: understand why if we use malloc we have problem with chilog
 
+        if (resuming){
+            // pick up the connection where the previous binary left it
+            registration = upgrade_state.registration;
+            output.compressed = registration.state == REG_REGISTERED && registration.compress;
+            if (upgrade_state.line_len > 0){
+                buffer_with_cmd_and_args = borrow_buffer(&line_pool);
+                memcpy(buffer_with_cmd_and_args, upgrade_state.line, upgrade_state.line_len);
+            }
+            num_chars_got = upgrade_state.line_len;
+            last_read_char = upgrade_state.last_read_char;
+        }
+
         while(1){
+            if (upgrade_was_requested()){
+                upgrade_state.listen_fd = socket_fd;
+                upgrade_state.client_fd = new_sock_fd;
+                upgrade_state.registration = registration;
+                upgrade_state.line_len = num_chars_got;
+                if (num_chars_got > 0) memcpy(upgrade_state.line, buffer_with_cmd_and_args, num_chars_got);
+                upgrade_state.last_read_char = last_read_char;
+                hand_off_to_new_binary(argv, &upgrade_state, p_user_head);
+                upgrade_state.client_fd = -1;
+            }
+            // a compressed connection that stays idle gives its compressor back
+            if (!wait_for_input(&output)) continue;
             // msg delimeted by CRLF
             bzero(buffer,256);
             n = recv(new_sock_fd, buffer, 255, 0);
@@ -255,6 +358,7 @@ int main(int argc, char *argv[])
 
             //if (n < 0) error("Error in reading from socket");
             if (n == 0) break;
+            if (n == -1 && errno == EINTR) continue;
             if (n == -1){
                 perror("Error reading from socket");
             }
@@ -264,53 +368,60 @@ int main(int argc, char *argv[])
             // command1: [par1, par2] 3 levels of depth
             // command2: [par1, par2]
             int i = 0;
-            while((current_read_char = buffer[i++]) != 0){ // until we have sth to read in the buffer
+            while(i < n){ // until we have sth to read in the buffer
+                // everything up to the next LF is copied at once, leaving the CRs out
+                int line_end = i + scan_for_byte(buffer + i, n - i, '\n');
+                if (line_end > i) last_read_char = buffer[line_end - 1];
+                while (i < line_end){
+                    int cr = i + scan_for_byte(buffer + i, line_end - i, '\r');
+                    int chunk = cr - i;
+                    if (num_chars_got + chunk > MAX_LINE_LEN - 1) chunk = MAX_LINE_LEN - 1 - num_chars_got; // too long: truncated
+                    if (chunk > 0){
+                        // an empty line (or the rest of a truncated one) needs no buffer
+                        if (!buffer_with_cmd_and_args) buffer_with_cmd_and_args = borrow_buffer(&line_pool);
+                        memcpy(buffer_with_cmd_and_args + num_chars_got, buffer + i, chunk);
+                        num_chars_got += chunk;
+                    }
+                    i = cr + 1;
+                }
+                i = line_end;
+                if (i == n) break;
+                current_read_char = buffer[i++]; // the LF
                 if (last_read_char == '\r' && current_read_char == '\n'){
                     // got end of the message
-                    // all the words up to now are parts of a COMMAND + [Args]
-                    bzero(cmd_and_args_array, sizeof(cmd_and_args_array));
                     // buffer_with_cmd_and_args -> holds all the chars up to CRLF
-                    // we get all the words in cmd_and_args_array
-                    parse_msg_for_cmd_and_args(buffer_with_cmd_and_args, cmd_and_args_array);
-                    bzero(buffer_with_cmd_and_args, 512);
-
-                    // TODO problem: NICK is read twice
-                    bzero(&received_cmd, sizeof(received_cmd));
-                    received_cmd = build_the_command(cmd_and_args_array);
-
-                    // check if the command can be processed
-                    if (!received_cmd.has_a_linked_command){
-                        command_can_be_processed = 1;
-                    } else{
-                        command_can_be_processed = 0;
-                        if (previous_cmd.cmd_filled_with_info && are_linked_commands(received_cmd, previous_cmd)){ // if it is linked to a command that already has info
-                            // link to previous
-                            received_cmd.linked_command = &previous_cmd;
-                            command_can_be_processed = 1;
+                    TRACE_LINE_FRAMED(output.connection_id, num_chars_got);
+                    if (buffer_with_cmd_and_args){
+                        buffer_with_cmd_and_args[num_chars_got] = 0;
+                        // the command points into the line: the line goes back to the pool after it is processed
+                        received_cmd = parse_the_command(buffer_with_cmd_and_args);
+                        if (received_cmd.cmd_string){
+                            TRACE_COMMAND_DISPATCHED(output.connection_id, received_cmd.id);
+                            process_the_command(&output, p_user_head, &received_cmd, &registration, host_lookup);
+                            TRACE_COMMAND_COMPLETED(output.connection_id, received_cmd.id);
                         }
-                    }
-
-                    // act if the command can be processed
-                    if (command_can_be_processed){
-                        process_the_command(new_sock_fd, p_user_head, received_cmd);
-                        //clean_the_command_buffer;
-                        bzero(&previous_cmd, sizeof(previous_cmd));
-
+                        return_buffer(&line_pool, buffer_with_cmd_and_args);
+                        buffer_with_cmd_and_args = NULL;
                     } else{
-                        previous_cmd = received_cmd;
+                        chilog(DEBUG, "Got an empty message, ignored");
                     }
                     num_chars_got = 0; //refresh the counter
                 }
-                if (current_read_char!='\r' && current_read_char!='\n'){
-                    *(buffer_with_cmd_and_args + num_chars_got++) = current_read_char;
-                    // save the char at memory area addressed. Pointer displaced by i units (here one byte per unit).
-                }
                 last_read_char = current_read_char;
             }
+            // the replies to all the commands got in this read leave together
+            flush_output(&output);
         }
 
         sleep(3); // avoid closing connection too fast
 
+        return_buffer(&line_pool, buffer_with_cmd_and_args);
+        close_output(&output);
+        release_host_lookup(host_lookup);
+        TRACE_CONNECTION_CLOSE(output.connection_id, new_sock_fd);
+        stats_connection_closed(registration.state == REG_REGISTERED);
+        remove_user_by_socket(p_user_head, new_sock_fd);
+        clear_registration(&registration);
         close(new_sock_fd);
     }
     return 0;
@@ -318,27 +429,30 @@ int main(int argc, char *argv[])
 
 
 
-void parse_msg_for_cmd_and_args(const char *input_baffer, char cmd_and_args[100][100]){
-    if (*input_baffer == 0) chilog(INFO,"Handle this problem. We just got CRLF");
-    // chilog(INFO,"Handle this problem. We just got CRLF") -> results in error
-    int index_word = 0, i = 0, j = 0;
-    char last_read_char = 0;
-    char processed_char;
-    while(*(input_baffer + i) != 0){
-        processed_char = *(input_baffer + i);
-        if (processed_char == ' '){ //space in the string buffer
-            if (last_read_char != ' '){
-                index_word++; //increase the word index only when we encounter the first space
-                j = 0; //reset the j counter used for placing the chars in cmd_and_args[(previous index_word)]
-            }
-            // if at next iteration an other space is found, it is skipped (index word is not changed)
+Command parse_the_command(char *line){
+    // the words are split in place: the command only points into the line
+    Command cmd_info;
+    bzero(&cmd_info, sizeof(cmd_info));
+    int len = strlen(line), i = 0;
+    while (i < len){
+        while (i < len && line[i] == ' ') i++; // a run of spaces is one separator
+        if (i == len) break;
+        char *word = line + i;
+        if (!cmd_info.cmd_string){
+            cmd_info.cmd_string = word;
+        } else if (*word == ':' || cmd_info.num_args == MAX_NUM_OF_PARAMS_FOR_CMD - 1){
+            // the trailing parameter takes the rest of the line, spaces included
+            cmd_info.args[cmd_info.num_args++] = *word == ':' ? word + 1 : word;
+            break;
         } else{
-            cmd_and_args[index_word][j++] = processed_char;
+            cmd_info.args[cmd_info.num_args++] = word;
         }
-        i++;
-        last_read_char = processed_char;
+        // a whole word is found at once
+        i += scan_for_byte(line + i, len - i, ' ');
+        if (i < len) line[i++] = 0;
     }
-
+    if (cmd_info.cmd_string) cmd_info.id = get_command_id(cmd_info.cmd_string);
+    return cmd_info;
 }
 
 //void process_the_command(int socket, User *user_db, char cmd_and_args[100][100]){
@@ -356,59 +470,113 @@ void parse_msg_for_cmd_and_args(const char *input_baffer, char cmd_and_args[100]
 //
 //}
 
-void process_the_command(int socket, User *user_db, Command cmd_info){
-    // consider the various possible commands
-    if (cmd_info.has_a_linked_command == 1){
-        if (!cmd_info.linked_command) perror("An expected linked command was not provided!");
+void process_registered_user_command(Output *out, User *user_db, Command *cmd_info, Registration *registration){
+    User *p_user = find_user_by_socket(user_db, out->socket_fd);
+    if (!p_user){
+        // commands we do not know are silently ignored until the connection registers
+        if (cmd_info -> id == CMD_UNKNOWN) return;
+        append_reply(out, TPL_NOTREGISTERED, registration -> nick_name ? registration -> nick_name -> string : "*");
+        return;
     }
-    char nick_name[100], user_name[100];
-    bzero(nick_name, 100);
-    bzero(user_name, 100);
+    char *nick = p_user->nick_name->string;
 
-    if (strncmp(cmd_info.cmd_string, "NICK",4) == 0){
-        strncpy(nick_name, cmd_info.args[0], 100);
-        strncpy(user_name, cmd_info.linked_command->args[0], 100);
-    }
-    if (strncmp(cmd_info.cmd_string, "USER",4) == 0){
-        strncpy(user_name, cmd_info.args[0], 100);
-        strncpy(nick_name, cmd_info.linked_command->args[0], 100);
+    if (cmd_info -> id == CMD_NAMES){
+        if (cmd_info -> num_args > 0){
+            // there are no channels yet, so no names to list for the ones asked
+            append_reply(out, TPL_ENDOFNAMES, nick, cmd_info -> args[0]);
+            return;
+        }
+        NamesCursor cursor;
+        start_names_cursor(&cursor, user_db);
+        while (emit_names(&cursor, out, nick)) flush_output_in_burst(out);
+    } else if (cmd_info -> id == CMD_LUSERS){
+        send_lusers(out, *p_user);
+    } else if (cmd_info -> id == CMD_MOTD){
+        append_motd(out, nick);
+    } else if (cmd_info -> id == CMD_LIST){
+        append_reply(out, TPL_LISTEND, nick);
+    } else{
+        chilog(INFO, "command yet to be implemented");
     }
-
-    User a_new_user = create_new_user(socket, user_db, nick_name, user_name);
-    send_greetings(socket, a_new_user);
 }
 
-
-Command build_the_command(char cmd_and_args[MAX_NUM_OF_PARAMS_FOR_CMD+1][100]){
-    Command cmd_info = {};
-    bzero(&cmd_info, sizeof(cmd_info));
-    // storing the command got
-    strncpy(cmd_info.cmd_string, cmd_and_args[0], 100);
-    if (strncmp(cmd_info.cmd_string, "NICK", 4) == 0) cmd_info.has_a_linked_command = 1;
-    if (strncmp(cmd_info.cmd_string, "USER", 4) == 0) cmd_info.has_a_linked_command = 1;
-
-    // storing the arguments provided
-    int i = 0;
-    char empty_array[100];
-    bzero(empty_array, 100);
-    while (strncmp(cmd_and_args[i + 1], empty_array, 100) != 0){
-        // argument to save
-        strncpy(cmd_info.args[i], cmd_and_args[i+1], 100);
-        i++;
+int process_the_command(Output *out, User *user_db, Command *cmd_info, Registration *registration, HostLookup *host_lookup){
+    // returns 1 if the command registered a new user
+    // PASS, NICK and USER only fill the registration, in whatever order they come
+    const char *nick = registration -> nick_name ? registration -> nick_name -> string : "*";
+    int registered = registration -> state == REG_REGISTERED;
+
+    switch (cmd_info -> id){
+    case CMD_PASS:
+        if (registered) append_reply(out, TPL_ALREADYREGISTRED, nick);
+        else if (cmd_info -> num_args < 1) append_reply(out, TPL_NEEDMOREPARAMS, nick, cmd_info -> cmd_string);
+        else{
+            registration -> got_pass = 1;
+            // PASS <password> <version> <flags> [<options>]
+            for (int i = 2; i < cmd_info -> num_args; i++)
+                if (compression_requested(cmd_info -> args[i])) registration -> compress = 1;
+        }
+        return 0;
+    case CMD_NICK:
+        if (cmd_info -> num_args < 1){
+            append_reply(out, TPL_NONICKNAMEGIVEN, nick);
+            return 0;
+        }
+        int nick_len = strlen(cmd_info -> args[0]);
+        if (nick_len > MAX_NICK_NAME_LEN || !is_valid_nick(cmd_info -> args[0], nick_len)){
+            append_reply(out, TPL_ERRONEUSNICKNAME, nick, cmd_info -> args[0]);
+            return 0;
+        }
+        if (registered){
+            chilog(INFO, "command yet to be implemented");
+            return 0;
+        }
+        set_registration_nick(registration, cmd_info -> args[0]);
+        break;
+    case CMD_USER:
+        if (registered){
+            append_reply(out, TPL_ALREADYREGISTRED, nick);
+            return 0;
+        }
+        if (cmd_info -> num_args < 4){
+            append_reply(out, TPL_NEEDMOREPARAMS, nick, cmd_info -> cmd_string);
+            return 0;
+        }
+        set_registration_user(registration, cmd_info -> args[0]);
+        break;
+    default:
+        process_registered_user_command(out, user_db, cmd_info, registration);
+        return 0;
     }
-    cmd_info.linked_command = NULL;
-    cmd_info.cmd_filled_with_info = 1;
-    //cmd_info.args = cmd_and_args // check but this should make the array points to the next element
-    return cmd_info;
+    if (registration -> state != REG_REGISTERED) return 0;
+
+    // the lookup started at accept time: usually it is done by now
+    char host_name[MAX_HOST_LEN];
+    wait_for_host(host_lookup, RESOLVER_TIMEOUT_MS, host_name);
+    if (registration -> compress){
+        // the errors got so far leave as they are: the stream starts with the welcome
+        flush_output(out);
+        out -> compressed = 1;
+    }
+    User a_new_user = create_new_user(out->socket_fd, user_db, registration -> nick_name -> string,
+                                      registration -> user_name -> string, host_name);
+    stats_connection_registered();
+    send_greetings(out, a_new_user);
+    send_lusers(out, a_new_user);
+    append_motd(out, a_new_user.nick_name->string);
+    return 1;
 }
 
 
-int are_linked_commands(Command first_command, Command second_command){
-    if (strncmp(first_command.cmd_string, "NICK", 4) == 0){
-        return (strncmp(second_command.cmd_string, "USER", 4) == 0);
-    }
-    if (strncmp(first_command.cmd_string, "USER", 4) == 0){
-        return (strncmp(second_command.cmd_string, "NICK", 4) == 0);
-    }
-    return 0;
-}
\ No newline at end of file
+command_id get_command_id(const char *cmd_string){
+    if (strncmp(cmd_string, "PASS", 5) == 0) return CMD_PASS;
+    if (strncmp(cmd_string, "NICK", 5) == 0) return CMD_NICK;
+    if (strncmp(cmd_string, "USER", 5) == 0) return CMD_USER;
+    if (strncmp(cmd_string, "LUSERS", 7) == 0) return CMD_LUSERS;
+    if (strncmp(cmd_string, "MOTD", 5) == 0) return CMD_MOTD;
+    if (strncmp(cmd_string, "NAMES", 6) == 0) return CMD_NAMES;
+    if (strncmp(cmd_string, "LIST", 5) == 0) return CMD_LIST;
+    if (strncmp(cmd_string, "PRIVMSG", 8) == 0) return CMD_PRIVMSG;
+    if (strncmp(cmd_string, "NOTICE", 7) == 0) return CMD_NOTICE;
+    return CMD_UNKNOWN;
+}
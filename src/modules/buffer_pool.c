@@ -0,0 +1,26 @@
+#include <stdlib.h>
+#include <interfaces/buffer_pool.h>
+
+// a free buffer stores the pointer to the next free one in its first bytes
+typedef struct FreeBuffer{
+    struct FreeBuffer *next;
+} FreeBuffer;
+
+char *borrow_buffer(BufferPool *pool){
+    FreeBuffer *buffer = pool -> free_list;
+    if (!buffer) return (char *) malloc(pool -> buffer_size);
+    pool -> free_list = buffer -> next;
+    pool -> num_free--;
+    return (char *) buffer;
+}
+
+void return_buffer(BufferPool *pool, char *buffer){
+    if (!buffer) return;
+    if (pool -> num_free >= pool -> max_free){
+        free(buffer);
+        return;
+    }
+    ((FreeBuffer *) buffer) -> next = pool -> free_list;
+    pool -> free_list = buffer;
+    pool -> num_free++;
+}
@@ -0,0 +1,87 @@
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include <interfaces/compress.h>
+#include <interfaces/output.h>
+
+#include <log.h>
+
+struct Compressor{
+    z_stream stream;
+    struct Compressor *next;
+};
+
+static Compressor *free_compressors = NULL;
+static int num_free_compressors = 0;
+
+// the server is single threaded: one flush is compressed at a time
+static unsigned char *compressed = NULL;
+static unsigned long compressed_size = 0;
+
+int compression_requested(const char *pass_param){
+    // the flags of PASS ("IRC|Z": after the '|') or its "Z" option
+    const char *bar = strchr(pass_param, '|');
+    if (bar) return strchr(bar + 1, 'Z') != NULL;
+    return strcmp(pass_param, "Z") == 0;
+}
+
+Compressor *borrow_compressor(){
+    Compressor *compressor = free_compressors;
+    if (compressor){
+        free_compressors = compressor -> next;
+        num_free_compressors--;
+        return compressor;
+    }
+    compressor = (Compressor *) calloc(1, sizeof(Compressor));
+    // negative window bits: raw deflate, no zlib header or trailer to keep per connection
+    if (deflateInit2(&compressor -> stream, COMPRESS_LEVEL, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK){
+        chilog(ERROR, "Could not create a compressor");
+        free(compressor);
+        return NULL;
+    }
+    return compressor;
+}
+
+void return_compressor(Compressor *compressor){
+    if (!compressor) return;
+    if (num_free_compressors >= MAX_FREE_COMPRESSORS){
+        deflateEnd(&compressor -> stream);
+        free(compressor);
+        return;
+    }
+    // the next connection starts from an empty history
+    deflateReset(&compressor -> stream);
+    compressor -> next = free_compressors;
+    free_compressors = compressor;
+    num_free_compressors++;
+}
+
+const char *compress_output(Compressor *compressor, const char *data, int len,
+                            compress_flush flush, int *compressed_len){
+    // returns the compressed data (valid up to the next call), or NULL
+    static const int zlib_flush[] = {[COMPRESS_MORE] = Z_NO_FLUSH, [COMPRESS_SYNC] = Z_SYNC_FLUSH};
+    z_stream *stream = &compressor -> stream;
+    if (!compressed){
+        compressed_size = deflateBound(stream, OUTPUT_BUFFER_SIZE) + 16; // + the flush marker
+        compressed = (unsigned char *) malloc(compressed_size);
+    }
+    stream -> next_in = (unsigned char *) data;
+    stream -> avail_in = len;
+    stream -> next_out = compressed;
+    stream -> avail_out = compressed_size;
+    int status;
+    // what was held back by earlier COMPRESS_MORE calls may not fit: grow until it does
+    while ((status = deflate(stream, zlib_flush[flush])) == Z_OK && stream -> avail_out == 0){
+        unsigned long used = compressed_size;
+        compressed_size *= 2;
+        compressed = (unsigned char *) realloc(compressed, compressed_size);
+        stream -> next_out = compressed + used;
+        stream -> avail_out = compressed_size - used;
+    }
+    if ((status != Z_OK && status != Z_BUF_ERROR) || stream -> avail_in > 0){
+        chilog(ERROR, "Could not compress the output");
+        return NULL;
+    }
+    *compressed_len = compressed_size - stream -> avail_out;
+    return (const char *) compressed;
+}
@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include <string.h>
+#include <interfaces/intern.h>
+#include <interfaces/memory.h>
+#include <interfaces/scan.h>
+
+#define INITIAL_NUM_BUCKETS 1024
+
+static InternedString **buckets = NULL;
+static unsigned int num_buckets = 0;
+static unsigned int num_strings = 0;
+
+static unsigned int hash_folded(const char *folded, int len){
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < len; i++){
+        hash ^= (unsigned char) folded[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void grow_buckets(){
+    unsigned int new_num_buckets = num_buckets ? num_buckets * 2 : INITIAL_NUM_BUCKETS;
+    InternedString **new_buckets = (InternedString **) alloc_pool_memory(new_num_buckets * sizeof(InternedString *));
+
+    for (unsigned int i = 0; i < num_buckets; i++){
+        InternedString *entry = buckets[i];
+        while (entry){
+            InternedString *next = entry -> next;
+            unsigned int index = entry -> hash & (new_num_buckets - 1);
+            entry -> next = new_buckets[index];
+            new_buckets[index] = entry;
+            entry = next;
+        }
+    }
+    free_pool_memory(buckets, num_buckets * sizeof(InternedString *));
+    buckets = new_buckets;
+    num_buckets = new_num_buckets;
+}
+
+static InternedString *lookup(const char *string, int len, unsigned int hash){
+    // case variants hash the same, so the exact string is checked in the bucket
+    if (!buckets) return NULL;
+    InternedString *entry = buckets[hash & (num_buckets - 1)];
+    while (entry){
+        if (entry -> hash == hash && strncmp(entry -> string, string, len + 1) == 0) return entry;
+        entry = entry -> next;
+    }
+    return NULL;
+}
+
+InternedString *intern_string(const char *string){
+    // returns the pooled copy of string with one more reference to it
+    int len = strlen(string);
+    char folded[len + 1];
+    fold_irc_case(folded, string, len + 1);
+    unsigned int hash = hash_folded(folded, len);
+
+    InternedString *entry = lookup(string, len, hash);
+    if (entry){
+        entry -> refcount++;
+        return entry;
+    }
+
+    if (num_strings >= num_buckets) grow_buckets();
+    // a single allocation holds the entry, the string and its folded form
+    entry = (InternedString *) malloc(sizeof(InternedString) + 2 * (len + 1));
+    entry -> string = (char *) (entry + 1);
+    entry -> folded = entry -> string + len + 1;
+    memcpy(entry -> string, string, len + 1);
+    memcpy(entry -> folded, folded, len + 1);
+    entry -> hash = hash;
+    entry -> refcount = 1;
+
+    unsigned int index = hash & (num_buckets - 1);
+    entry -> next = buckets[index];
+    buckets[index] = entry;
+    num_strings++;
+    return entry;
+}
+
+void release_string(InternedString *interned){
+    if (!interned || --(interned -> refcount) > 0) return;
+
+    InternedString **p_entry = &buckets[interned -> hash & (num_buckets - 1)];
+    while (*p_entry != interned) p_entry = &(*p_entry) -> next;
+    *p_entry = interned -> next;
+    num_strings--;
+    free(interned);
+}
+
+int interned_equal_nocase(InternedString *a, InternedString *b){
+    if (a == b) return 1;
+    return a -> hash == b -> hash && strcmp(a -> folded, b -> folded) == 0;
+}
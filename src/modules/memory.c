@@ -0,0 +1,36 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <interfaces/memory.h>
+
+#include <log.h>
+
+void *alloc_pool_memory(size_t size){
+    // returns zeroed memory, NULL if it could not be allocated
+    if (size < HUGE_PAGE_SIZE) return calloc(1, size);
+
+    // round up to whole huge pages and map one more to be able to align the start
+    size_t mapped_size = (size + HUGE_PAGE_SIZE - 1) & ~((size_t) HUGE_PAGE_SIZE - 1);
+    char *mapping = mmap(NULL, mapped_size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) return NULL;
+
+    char *aligned = (char *) (((uintptr_t) mapping + HUGE_PAGE_SIZE - 1) & ~((uintptr_t) HUGE_PAGE_SIZE - 1));
+    if (aligned > mapping) munmap(mapping, aligned - mapping);
+    munmap(aligned + mapped_size, mapping + HUGE_PAGE_SIZE - aligned);
+#ifdef MADV_HUGEPAGE
+    if (madvise(aligned, mapped_size, MADV_HUGEPAGE) < 0)
+        chilog(DEBUG, "Transparent huge pages not available for a pool of %zu bytes", size);
+#endif
+    return aligned;
+}
+
+void free_pool_memory(void *memory, size_t size){
+    if (!memory) return;
+    if (size < HUGE_PAGE_SIZE){
+        free(memory);
+        return;
+    }
+    munmap(memory, (size + HUGE_PAGE_SIZE - 1) & ~((size_t) HUGE_PAGE_SIZE - 1));
+}
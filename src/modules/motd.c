@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <interfaces/motd.h>
+#include <interfaces/replies.h>
+
+#include <log.h>
+
+static Motd *current_motd = NULL;
+static char *motd_file_name = MOTD_FILE;
+static volatile sig_atomic_t motd_reload_requested = 0;
+static struct stat loaded_stat; // of the file the current MOTD was read from
+static int loaded_exists = 0;
+
+static Motd *build_motd(const char *text, size_t size){
+    // counts the lines first so that body and offsets are allocated only once
+    int num_lines = 0;
+    for (size_t i = 0; i < size; i++){
+        if (text[i] == '\n' || i == size - 1) num_lines++;
+    }
+
+    Motd *motd = (Motd *) malloc(sizeof(Motd));
+    motd -> num_lines = num_lines;
+    motd -> line_offsets = (int *) malloc((num_lines + 1) * sizeof(int));
+    motd -> body = (char *) malloc(size + num_lines * 6 + 1); // " :- " and CRLF per line
+
+    size_t line_start = 0;
+    int len = 0, line = 0;
+    for (size_t i = 0; i < size; i++){
+        if (text[i] != '\n' && i != size - 1) continue;
+        size_t line_end = (text[i] == '\n') ? i : i + 1;
+        if (line_end > line_start && text[line_end - 1] == '\r') line_end--;
+
+        motd -> line_offsets[line++] = len;
+        memcpy(motd -> body + len, " :- ", 4);
+        len += 4;
+        memcpy(motd -> body + len, text + line_start, line_end - line_start);
+        len += line_end - line_start;
+        motd -> body[len++] = '\r';
+        motd -> body[len++] = '\n';
+        line_start = i + 1;
+    }
+    motd -> line_offsets[num_lines] = len;
+    return motd;
+}
+
+static void free_motd(Motd *motd){
+    free(motd -> line_offsets);
+    free(motd -> body);
+    free(motd);
+}
+
+int load_motd(const char *file_name){
+    // returns 0 if the file could not be read: the MOTD is then reported as missing
+    Motd *new_motd = NULL;
+    struct stat file_stat;
+    int fd = open(file_name, O_RDONLY);
+
+    motd_file_name = (char *) file_name;
+    loaded_exists = fd >= 0 && fstat(fd, &file_stat) == 0;
+    if (loaded_exists){
+        loaded_stat = file_stat;
+        if (file_stat.st_size == 0){
+            new_motd = build_motd("", 0);
+        } else{
+            char *text = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (text != MAP_FAILED){
+                new_motd = build_motd(text, file_stat.st_size);
+                munmap(text, file_stat.st_size);
+            }
+        }
+    }
+    if (fd >= 0) close(fd);
+
+    if (current_motd) free_motd(current_motd);
+    current_motd = new_motd;
+    chilog(DEBUG, "MOTD %s (%d lines)", new_motd ? "loaded" : "missing", new_motd ? new_motd -> num_lines : 0);
+    return new_motd != NULL;
+}
+
+static void request_motd_reload(int signum){
+    motd_reload_requested = 1;
+}
+
+void install_motd_reload_handler(){
+    // SIGHUP only raises a flag, the reload happens when the MOTD is next needed
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_motd_reload;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGHUP, &action, NULL);
+}
+
+static int motd_file_changed(){
+    struct stat file_stat;
+    int exists = stat(motd_file_name, &file_stat) == 0;
+    if (exists != loaded_exists) return 1;
+    return exists && (file_stat.st_ino != loaded_stat.st_ino || file_stat.st_dev != loaded_stat.st_dev
+                      || file_stat.st_size != loaded_stat.st_size
+                      || file_stat.st_mtim.tv_sec != loaded_stat.st_mtim.tv_sec
+                      || file_stat.st_mtim.tv_nsec != loaded_stat.st_mtim.tv_nsec);
+}
+
+Motd *get_motd(){
+    // NULL if there is no MOTD file
+    if (motd_reload_requested || motd_file_changed()){
+        motd_reload_requested = 0;
+        load_motd(motd_file_name);
+    }
+    return current_motd;
+}
+
+void append_motd(Output *out, const char *nick){
+    Motd *motd = get_motd();
+    if (!motd){
+        append_reply(out, TPL_NOMOTD, nick);
+        return;
+    }
+
+    int prefix_len, nick_len = strlen(nick);
+    const char *prefix = reply_prefix(TPL_MOTD, &prefix_len);
+    int room = MAX_MSG_LEN - 2; // CRLF always fits
+    if (prefix_len + nick_len > room) nick_len = room - prefix_len > 0 ? room - prefix_len : 0;
+
+    append_reply(out, TPL_MOTDSTART, nick);
+    for (int i = 0; i < motd -> num_lines; i++){
+        int text_len = motd -> line_offsets[i + 1] - motd -> line_offsets[i] - 2; // without its CRLF
+        int len = prefix_len + nick_len;
+        // too long for IRC: the line is truncated but keeps its CRLF
+        if (len + text_len > room) text_len = room - len > 0 ? room - len : 0;
+        char *dst = reserve_output(out, MAX_MSG_LEN);
+        memcpy(dst, prefix, prefix_len);
+        memcpy(dst + prefix_len, nick, nick_len);
+        memcpy(dst + len, motd -> body + motd -> line_offsets[i], text_len);
+        len += text_len;
+        dst[len++] = '\r';
+        dst[len++] = '\n';
+        commit_output(out, len);
+    }
+    append_reply(out, TPL_ENDOFMOTD, nick);
+}
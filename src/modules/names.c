@@ -0,0 +1,54 @@
+#include <string.h>
+#include <interfaces/names.h>
+#include <interfaces/replies.h>
+
+void start_names_cursor(NamesCursor *cursor, User *p_user_head){
+    cursor -> next_user = p_user_head -> nick_name ? p_user_head : NULL;
+    cursor -> done = 0;
+}
+
+int emit_names(NamesCursor *cursor, Output *out, const char *nick){
+    // returns 1 if there is still something to send once the output is flushed
+    int prefix_len, nick_len = strlen(nick);
+    const char *prefix = reply_prefix(TPL_NAMREPLY, &prefix_len);
+    int room = MAX_MSG_LEN - 2; // CRLF always fits
+    if (prefix_len + nick_len + 6 > room) nick_len = room - prefix_len - 6 > 0 ? room - prefix_len - 6 : 0;
+
+    // users are not in channels yet: they are all listed under "*"
+    while (cursor -> next_user && OUTPUT_BUFFER_SIZE - out -> len >= MAX_MSG_LEN){
+        char *dst = reserve_output(out, MAX_MSG_LEN);
+        int len = 0;
+        memcpy(dst, prefix, prefix_len);
+        len += prefix_len;
+        memcpy(dst + len, nick, nick_len);
+        len += nick_len;
+        memcpy(dst + len, " * * :", 6);
+        len += 6;
+
+        int first = 1;
+        while (cursor -> next_user){
+            InternedString *name = cursor -> next_user -> nick_name;
+            int name_len = strlen(name -> string);
+            if (len + !first + name_len > room){
+                if (!first) break; // goes on the next line
+                name_len = room - len; // not even alone on a line: truncated
+            }
+            if (!first) dst[len++] = ' ';
+            memcpy(dst + len, name -> string, name_len);
+            len += name_len;
+            first = 0;
+            cursor -> next_user = cursor -> next_user -> next;
+        }
+        dst[len++] = '\r';
+        dst[len++] = '\n';
+        commit_output(out, len);
+    }
+    if (cursor -> next_user) return 1;
+
+    if (!cursor -> done){
+        if (OUTPUT_BUFFER_SIZE - out -> len < MAX_MSG_LEN) return 1;
+        append_reply(out, TPL_ENDOFNAMES, nick, "*");
+        cursor -> done = 1;
+    }
+    return 0;
+}
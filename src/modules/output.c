@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <interfaces/output.h>
+#include <interfaces/buffer_pool.h>
+#include <interfaces/trace.h>
+#include <interfaces/compress.h>
+
+#include <log.h>
+
+static BufferPool output_pool = BUFFER_POOL(OUTPUT_BUFFER_SIZE, 64);
+
+void set_socket_buffer_sizes(int listen_fd, int send_size, int receive_size){
+    // on the listening socket before listen(): the accepted sockets inherit the
+    // sizes, and the window scale the receive size needs is fixed in the SYN-ACK.
+    // 0 leaves the kernel default
+    if (send_size > 0 && setsockopt(listen_fd, SOL_SOCKET, SO_SNDBUF, &send_size, sizeof(int)) < 0)
+        perror("Error setting SO_SNDBUF");
+    if (receive_size > 0 && setsockopt(listen_fd, SOL_SOCKET, SO_RCVBUF, &receive_size, sizeof(int)) < 0)
+        perror("Error setting SO_RCVBUF");
+}
+
+void configure_client_socket(int socket_fd){
+    int on = 1;
+    if (setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) < 0)
+        perror("Error setting TCP_NODELAY");
+}
+
+static void set_cork(Output *out, int on){
+#ifdef TCP_CORK
+    if (setsockopt(out -> socket_fd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on)) < 0)
+        perror("Error setting TCP_CORK");
+#endif
+    out -> corked = on;
+}
+
+void init_output(Output *out, int socket_fd, unsigned long connection_id){
+    out -> socket_fd = socket_fd;
+    out -> connection_id = connection_id;
+    out -> len = 0;
+    out -> corked = 0;
+    out -> compressed = 0;
+    out -> compressor = NULL;
+    out -> buffer = NULL;
+}
+
+char *reserve_output(Output *out, int needed){
+    // returns where to write the next `needed` bytes, flushing first if they do not fit
+    if (out -> len + needed > OUTPUT_BUFFER_SIZE) flush_output_in_burst(out);
+    if (!out -> buffer) out -> buffer = borrow_buffer(&output_pool);
+    return out -> buffer + out -> len;
+}
+
+void commit_output(Output *out, int len){
+    // the `len` bytes written where reserve_output() said are a message to send
+    out -> len += len;
+    TRACE_MESSAGE_ENQUEUED(out -> connection_id, len);
+}
+
+static void send_output(Output *out, compress_flush flush){
+    int sent = 0, n;
+    // a compressor may still hold back output from the burst even if the buffer is empty
+    if (out -> len == 0 && !out -> compressor) return;
+    chilog(TRACE, "Sending to socket: %.*s", out -> len, out -> buffer);
+    const char *data = out -> buffer;
+    int len = out -> len;
+    if (out -> compressed){
+        if (!out -> compressor && !(out -> compressor = borrow_compressor())){
+            out -> len = 0;
+            return;
+        }
+        data = compress_output(out -> compressor, out -> buffer, out -> len, flush, &len);
+        if (!data){
+            return_compressor(out -> compressor);
+            out -> compressor = NULL;
+            out -> len = 0;
+            return;
+        }
+    }
+    while (sent < len){
+        n = send(out -> socket_fd, data + sent, len - sent, 0);
+        if (n < 0 && errno == EINTR) continue; // e.g. SIGUSR2, which has no SA_RESTART
+        if (n < 0){
+            perror("ERROR writing to socket");
+            break;
+        }
+        sent += n;
+    }
+    TRACE_MESSAGE_FLUSHED(out -> connection_id, sent);
+    out -> len = 0;
+}
+
+void flush_output_in_burst(Output *out){
+    // more is coming in this iteration: no partial segment has to leave now
+    if (!out -> corked) set_cork(out, 1);
+    send_output(out, COMPRESS_MORE);
+}
+
+int wait_for_input(Output *out){
+    // called before blocking on the socket. Returns 0 if a signal interrupted
+    // the wait: the caller checks it before blocking again
+    if (!out -> compressor) return 1;
+    struct pollfd socket_poll = {out -> socket_fd, POLLIN, 0};
+    int ready = poll(&socket_poll, 1, COMPRESS_IDLE_TIMEOUT_MS);
+    if (ready < 0 && errno == EINTR) return 0;
+    if (ready == 0){
+        // idle: the last reply ended with a sync flush, nothing more has to be sent
+        return_compressor(out -> compressor);
+        out -> compressor = NULL;
+    }
+    return 1;
+}
+
+void flush_output(Output *out){
+    // end of the iteration: whatever is left goes out now and the buffer goes back
+    send_output(out, COMPRESS_SYNC);
+    if (out -> corked) set_cork(out, 0);
+    return_buffer(&output_pool, out -> buffer);
+    out -> buffer = NULL;
+}
+
+void close_output(Output *out){
+    // the connection is gone: nothing is sent, buffer and compressor go back
+    return_buffer(&output_pool, out -> buffer);
+    out -> buffer = NULL;
+    out -> len = 0;
+    return_compressor(out -> compressor);
+    out -> compressor = NULL;
+}
@@ -0,0 +1,39 @@
+#include <stddef.h>
+#include <interfaces/registration.h>
+
+void init_registration(Registration *registration){
+    registration -> state = REG_WAITING;
+    registration -> got_pass = 0;
+    registration -> compress = 0;
+    registration -> nick_name = NULL;
+    registration -> user_name = NULL;
+}
+
+static registration_state next_state(Registration *registration){
+    if (registration -> state == REG_REGISTERED) return REG_REGISTERED;
+    if (registration -> nick_name && registration -> user_name) return REG_REGISTERED;
+    if (registration -> nick_name) return REG_GOT_NICK;
+    if (registration -> user_name) return REG_GOT_USER;
+    return REG_WAITING;
+}
+
+registration_state set_registration_nick(Registration *registration, const char *nick_name){
+    // a NICK sent again before registering replaces the previous one
+    InternedString *old_nick_name = registration -> nick_name;
+    registration -> nick_name = intern_string(nick_name);
+    release_string(old_nick_name);
+    return registration -> state = next_state(registration);
+}
+
+registration_state set_registration_user(Registration *registration, const char *user_name){
+    InternedString *old_user_name = registration -> user_name;
+    registration -> user_name = intern_string(user_name);
+    release_string(old_user_name);
+    return registration -> state = next_state(registration);
+}
+
+void clear_registration(Registration *registration){
+    release_string(registration -> nick_name);
+    release_string(registration -> user_name);
+    init_registration(registration);
+}
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <interfaces/replies.h>
+#include <reply.h>
+
+#include <log.h>
+
+// A reply is ":<servername> <code> <nick><params><fixed_text>\r\n".
+// The prefix (":<servername> <code> ") is rendered once at startup, the fixed
+// text is copied as it is, and only the params are formatted for each reply.
+// A "%s" in the fixed text stands for the servername and is rendered at startup too.
+typedef struct ReplyTemplate{
+    const char *code;
+    const char *params_fmt;
+    const char *fixed_text;
+    char *prefix;
+    int prefix_len;
+    int fixed_text_len;
+} ReplyTemplate;
+
+static ReplyTemplate templates[NUM_REPLY_TEMPLATES] = {
+        [TPL_WELCOME]          = {RPL_WELCOME, " :Welcome to the Internet Relay Network %s!%s@%s", ""},
+        [TPL_YOURHOST]         = {RPL_YOURHOST, "", " :Your host is %s, running version " CHIRC_VERSION},
+        [TPL_CREATED]          = {RPL_CREATED, " :This server was created %s", ""},
+        [TPL_MYINFO]           = {RPL_MYINFO, "", " %s " CHIRC_VERSION " ao mtov"},
+        [TPL_LUSERCLIENT]      = {RPL_LUSERCLIENT, " :There are %d users and 0 services on %d servers", ""},
+        [TPL_LUSEROP]          = {RPL_LUSEROP, " %d", " :operator(s) online"},
+        [TPL_LUSERUNKNOWN]     = {RPL_LUSERUNKNOWN, " %d", " :unknown connection(s)"},
+        [TPL_LUSERCHANNELS]    = {RPL_LUSERCHANNELS, " %d", " :channels formed"},
+        [TPL_LUSERME]          = {RPL_LUSERME, " :I have %d clients and %d servers", ""},
+        [TPL_MOTDSTART]        = {RPL_MOTDSTART, "", " :- %s Message of the day - "},
+        [TPL_MOTD]             = {RPL_MOTD, " :- %s", ""},
+        [TPL_ENDOFMOTD]        = {RPL_ENDOFMOTD, "", " :End of MOTD command"},
+        [TPL_NOMOTD]           = {ERR_NOMOTD, "", " :MOTD File is missing"},
+        [TPL_NAMREPLY]         = {RPL_NAMREPLY, " %s %s :%s", ""},
+        [TPL_ENDOFNAMES]       = {RPL_ENDOFNAMES, " %s", " :End of NAMES list"},
+        [TPL_LISTEND]          = {RPL_LISTEND, "", " :End of LIST"},
+        [TPL_NOTREGISTERED]    = {ERR_NOTREGISTERED, "", " :You have not registered"},
+        [TPL_NONICKNAMEGIVEN]  = {ERR_NONICKNAMEGIVEN, "", " :No nickname given"},
+        [TPL_ERRONEUSNICKNAME] = {ERR_ERRONEUSNICKNAME, " %s", " :Erroneous nickname"},
+        [TPL_NEEDMOREPARAMS]   = {ERR_NEEDMOREPARAMS, " %s", " :Not enough parameters"},
+        [TPL_ALREADYREGISTRED] = {ERR_ALREADYREGISTRED, "", " :Unauthorized command (already registered)"},
+};
+
+void init_reply_templates(const char *servername){
+    for (int i = 0; i < NUM_REPLY_TEMPLATES; i++){
+        ReplyTemplate *tpl = &templates[i];
+        tpl -> prefix_len = strlen(servername) + strlen(tpl -> code) + 3; // ':' and two spaces
+        tpl -> prefix = (char *) malloc(tpl -> prefix_len + 1);
+        sprintf(tpl -> prefix, ":%s %s ", servername, tpl -> code);
+        if (strstr(tpl -> fixed_text, "%s")){
+            char *fixed_text = (char *) malloc(strlen(tpl -> fixed_text) + strlen(servername) + 1);
+            sprintf(fixed_text, tpl -> fixed_text, servername);
+            tpl -> fixed_text = fixed_text;
+        }
+        tpl -> fixed_text_len = strlen(tpl -> fixed_text);
+    }
+}
+
+void append_reply(Output *out, reply_template_id id, const char *nick, ...){
+    ReplyTemplate *tpl = &templates[id];
+    char *dst = reserve_output(out, MAX_MSG_LEN);
+    int room = MAX_MSG_LEN - 2; // CRLF always fits
+    int len, nick_len = strlen(nick);
+    va_list args;
+
+    // the fixed text (the trailing parameter) always fits: nick and params get what is left
+    int params_room = room - tpl -> fixed_text_len;
+    memcpy(dst, tpl -> prefix, tpl -> prefix_len);
+    len = tpl -> prefix_len;
+    if (len + nick_len > params_room) nick_len = params_room - len;
+    memcpy(dst + len, nick, nick_len);
+    len += nick_len;
+
+    va_start(args, nick);
+    len += vsnprintf(dst + len, params_room - len + 1, tpl -> params_fmt, args);
+    va_end(args);
+    if (len > params_room) len = params_room; // truncated by vsnprintf
+
+    memcpy(dst + len, tpl -> fixed_text, tpl -> fixed_text_len);
+    len += tpl -> fixed_text_len;
+    dst[len++] = '\r';
+    dst[len++] = '\n';
+    commit_output(out, len);
+}
+
+const char *reply_prefix(reply_template_id id, int *prefix_len){
+    // for the modules that pre-render whole replies on their own (e.g. the MOTD)
+    *prefix_len = templates[id].prefix_len;
+    return templates[id].prefix;
+}
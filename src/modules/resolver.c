@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <interfaces/resolver.h>
+
+#include <log.h>
+
+typedef struct CacheEntry{
+    int family; // 0 for an empty entry
+    unsigned char key[16];
+    time_t expires;
+    char host[MAX_HOST_LEN];
+} CacheEntry;
+
+// one lock for the queue, the cache and the lookups: the work done under it is tiny
+static pthread_mutex_t resolver_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_available = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t lookup_done = PTHREAD_COND_INITIALIZER;
+static HostLookup *pending_head = NULL, *pending_tail = NULL;
+static CacheEntry cache[RESOLVER_CACHE_SIZE];
+
+static int address_key(const struct sockaddr_storage *address, unsigned char key[16]){
+    // returns the family, 0 if it is not an IP address
+    if (address -> ss_family == AF_INET){
+        memcpy(key, &((struct sockaddr_in *) address) -> sin_addr, 4);
+        return AF_INET;
+    }
+    if (address -> ss_family == AF_INET6){
+        memcpy(key, &((struct sockaddr_in6 *) address) -> sin6_addr, 16);
+        return AF_INET6;
+    }
+    return 0;
+}
+
+static CacheEntry *cache_slot(int family, const unsigned char key[16]){
+    // direct mapped: a new answer simply replaces whatever was in its slot
+    int len = family == AF_INET ? 4 : 16;
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < len; i++){
+        hash ^= key[i];
+        hash *= 16777619u;
+    }
+    return &cache[hash % RESOLVER_CACHE_SIZE];
+}
+
+static int name_confirms_address(const char *host, int family, const unsigned char key[16]){
+    // the PTR answer is up to whoever owns the reverse zone: the name must resolve back to the address
+    struct addrinfo hints, *results, *result;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = family;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, NULL, &hints, &results) != 0) return 0;
+
+    int confirmed = 0;
+    for (result = results; result && !confirmed; result = result -> ai_next){
+        unsigned char result_key[16] = {0};
+        confirmed = address_key((struct sockaddr_storage *) result -> ai_addr, result_key) == family
+                    && memcmp(result_key, key, 16) == 0;
+    }
+    freeaddrinfo(results);
+    return confirmed;
+}
+
+static void finish_lookup(HostLookup *lookup){
+    // called with the lock held
+    lookup -> done = 1;
+    pthread_cond_broadcast(&lookup_done);
+    if (--(lookup -> refcount) == 0) free(lookup);
+}
+
+static void *resolver_thread(void *arg){
+    while (1){
+        pthread_mutex_lock(&resolver_lock);
+        while (!pending_head) pthread_cond_wait(&work_available, &resolver_lock);
+        HostLookup *lookup = pending_head;
+        pending_head = lookup -> next_pending;
+        if (!pending_head) pending_tail = NULL;
+        pthread_mutex_unlock(&resolver_lock);
+
+        char host[MAX_HOST_LEN];
+        unsigned char key[16] = {0};
+        int family = address_key(&lookup -> address, key);
+        int found = getnameinfo((struct sockaddr *) &lookup -> address, lookup -> address_len,
+                                host, sizeof(host), NULL, 0, NI_NAMEREQD) == 0
+                    && name_confirms_address(host, family, key);
+
+        pthread_mutex_lock(&resolver_lock);
+        // a failure is cached too (as the numeric address), or every reconnect would go back to DNS
+        if (found) strncpy(lookup -> host, host, MAX_HOST_LEN);
+        CacheEntry *entry = cache_slot(family, key);
+        entry -> family = family;
+        memcpy(entry -> key, key, 16);
+        entry -> expires = time(NULL) + (found ? RESOLVER_CACHE_TTL : RESOLVER_FAILED_TTL);
+        strncpy(entry -> host, lookup -> host, MAX_HOST_LEN);
+        finish_lookup(lookup);
+        pthread_mutex_unlock(&resolver_lock);
+    }
+    return NULL;
+}
+
+void start_resolver(int num_threads){
+    for (int i = 0; i < num_threads; i++){
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, resolver_thread, NULL) != 0){
+            chilog(ERROR, "Could not start resolver thread");
+            continue;
+        }
+        pthread_detach(thread);
+    }
+}
+
+HostLookup *resolve_host_async(const struct sockaddr *address, socklen_t address_len){
+    HostLookup *lookup = (HostLookup *) calloc(1, sizeof(HostLookup));
+    memcpy(&lookup -> address, address, address_len);
+    lookup -> address_len = address_len;
+    lookup -> refcount = 1;
+    if (getnameinfo(address, address_len, lookup -> host, MAX_HOST_LEN, NULL, 0, NI_NUMERICHOST) != 0)
+        strcpy(lookup -> host, "unknown");
+
+    unsigned char key[16] = {0};
+    int family = address_key(&lookup -> address, key);
+    if (!family){
+        lookup -> done = 1;
+        return lookup;
+    }
+
+    pthread_mutex_lock(&resolver_lock);
+    CacheEntry *entry = cache_slot(family, key);
+    if (entry -> family == family && memcmp(entry -> key, key, 16) == 0 && entry -> expires > time(NULL)){
+        strncpy(lookup -> host, entry -> host, MAX_HOST_LEN);
+        lookup -> done = 1;
+    } else{
+        lookup -> refcount++; // one for the resolver thread
+        if (pending_tail) pending_tail -> next_pending = lookup;
+        else pending_head = lookup;
+        pending_tail = lookup;
+        pthread_cond_signal(&work_available);
+    }
+    pthread_mutex_unlock(&resolver_lock);
+    return lookup;
+}
+
+void wait_for_host(HostLookup *lookup, int timeout_ms, char *host){
+    // copies the hostname in host (MAX_HOST_LEN bytes), the numeric address if it is not known in time
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L){
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&resolver_lock);
+    while (!lookup -> done){
+        if (pthread_cond_timedwait(&lookup_done, &resolver_lock, &deadline) == ETIMEDOUT) break;
+    }
+    strncpy(host, lookup -> host, MAX_HOST_LEN);
+    pthread_mutex_unlock(&resolver_lock);
+}
+
+void release_host_lookup(HostLookup *lookup){
+    if (!lookup) return;
+    pthread_mutex_lock(&resolver_lock);
+    if (--(lookup -> refcount) == 0) free(lookup);
+    pthread_mutex_unlock(&resolver_lock);
+}
@@ -0,0 +1,189 @@
+#include <interfaces/scan.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+static int scan_for_byte_scalar(const char *s, int len, char byte){
+    for (int i = 0; i < len; i++){
+        if (s[i] == byte) return i;
+    }
+    return len;
+}
+
+static void fold_irc_case_scalar(char *dst, const char *src, int len){
+    for (int i = 0; i < len; i++){
+        char c = src[i];
+        dst[i] = (c >= 'A' && c <= '^') ? c + 32 : c;
+    }
+}
+
+static int is_nick_char(char c){
+    // 'A'..'}' holds the letters and all of []\`_^{|}
+    return (c >= 'A' && c <= '}') || (c >= '0' && c <= '9') || c == '-';
+}
+
+static int is_channel_char(char c){
+    return c != 0 && c != 7 && c != '\r' && c != '\n' && c != ' ' && c != ',' && c != ':';
+}
+
+static int is_valid_nick_scalar(const char *nick, int len){
+    if (len == 0 || (nick[0] >= '0' && nick[0] <= '9') || nick[0] == '-') return 0;
+    for (int i = 0; i < len; i++){
+        if (!is_nick_char(nick[i])) return 0;
+    }
+    return 1;
+}
+
+static int is_valid_channel_name_scalar(const char *name, int len){
+    if (len < 2 || (name[0] != '#' && name[0] != '&')) return 0;
+    for (int i = 1; i < len; i++){
+        if (!is_channel_char(name[i])) return 0;
+    }
+    return 1;
+}
+
+#ifdef HAVE_X86_KERNELS
+
+// Bytes >= 0x80 are negative for the signed compares, so they are never in a range.
+
+__attribute__((target("sse2")))
+static int scan_for_byte_sse2(const char *s, int len, char byte){
+    __m128i needle = _mm_set1_epi8(byte);
+    int i = 0;
+    for (; i + 16 <= len; i += 16){
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (s + i)), needle));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scan_for_byte_scalar(s + i, len - i, byte);
+}
+
+__attribute__((target("sse2")))
+static void fold_irc_case_sse2(char *dst, const char *src, int len){
+    __m128i above = _mm_set1_epi8('A' - 1), below = _mm_set1_epi8('^' + 1), delta = _mm_set1_epi8(32);
+    int i = 0;
+    for (; i + 16 <= len; i += 16){
+        __m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(x, above), _mm_cmplt_epi8(x, below));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_add_epi8(x, _mm_and_si128(upper, delta)));
+    }
+    fold_irc_case_scalar(dst + i, src + i, len - i);
+}
+
+__attribute__((target("sse2")))
+static int nick_chars_ok_sse2(const char *nick, int len){
+    __m128i lo1 = _mm_set1_epi8('A' - 1), hi1 = _mm_set1_epi8('}' + 1);
+    __m128i lo2 = _mm_set1_epi8('0' - 1), hi2 = _mm_set1_epi8('9' + 1), dash = _mm_set1_epi8('-');
+    int i = 0;
+    for (; i + 16 <= len; i += 16){
+        __m128i x = _mm_loadu_si128((const __m128i *) (nick + i));
+        __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(x, lo1), _mm_cmplt_epi8(x, hi1));
+        ok = _mm_or_si128(ok, _mm_and_si128(_mm_cmpgt_epi8(x, lo2), _mm_cmplt_epi8(x, hi2)));
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(x, dash));
+        if (_mm_movemask_epi8(ok) != 0xFFFF) return 0;
+    }
+    for (; i < len; i++){
+        if (!is_nick_char(nick[i])) return 0;
+    }
+    return 1;
+}
+
+__attribute__((target("sse2")))
+static int is_valid_nick_sse2(const char *nick, int len){
+    if (len == 0 || (nick[0] >= '0' && nick[0] <= '9') || nick[0] == '-') return 0;
+    return nick_chars_ok_sse2(nick, len);
+}
+
+__attribute__((target("sse2")))
+static int is_valid_channel_name_sse2(const char *name, int len){
+    if (len < 2 || (name[0] != '#' && name[0] != '&')) return 0;
+    const char forbidden[] = {0, 7, '\r', '\n', ' ', ',', ':'};
+    int i = 1;
+    for (; i + 16 <= len; i += 16){
+        __m128i x = _mm_loadu_si128((const __m128i *) (name + i));
+        __m128i bad = _mm_setzero_si128();
+        for (int f = 0; f < (int) sizeof(forbidden); f++)
+            bad = _mm_or_si128(bad, _mm_cmpeq_epi8(x, _mm_set1_epi8(forbidden[f])));
+        if (_mm_movemask_epi8(bad)) return 0;
+    }
+    for (; i < len; i++){
+        if (!is_channel_char(name[i])) return 0;
+    }
+    return 1;
+}
+
+__attribute__((target("avx2")))
+static int scan_for_byte_avx2(const char *s, int len, char byte){
+    __m256i needle = _mm256_set1_epi8(byte);
+    int i = 0;
+    for (; i + 32 <= len; i += 32){
+        unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (s + i)), needle));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scan_for_byte_sse2(s + i, len - i, byte);
+}
+
+__attribute__((target("avx2")))
+static void fold_irc_case_avx2(char *dst, const char *src, int len){
+    __m256i above = _mm256_set1_epi8('A' - 1), below = _mm256_set1_epi8('^' + 1), delta = _mm256_set1_epi8(32);
+    int i = 0;
+    for (; i + 32 <= len; i += 32){
+        __m256i x = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(x, above), _mm256_cmpgt_epi8(below, x));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_add_epi8(x, _mm256_and_si256(upper, delta)));
+    }
+    fold_irc_case_sse2(dst + i, src + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static int is_valid_nick_avx2(const char *nick, int len){
+    if (len == 0 || (nick[0] >= '0' && nick[0] <= '9') || nick[0] == '-') return 0;
+    __m256i lo1 = _mm256_set1_epi8('A' - 1), hi1 = _mm256_set1_epi8('}' + 1);
+    __m256i lo2 = _mm256_set1_epi8('0' - 1), hi2 = _mm256_set1_epi8('9' + 1), dash = _mm256_set1_epi8('-');
+    int i = 0;
+    for (; i + 32 <= len; i += 32){
+        __m256i x = _mm256_loadu_si256((const __m256i *) (nick + i));
+        __m256i ok = _mm256_and_si256(_mm256_cmpgt_epi8(x, lo1), _mm256_cmpgt_epi8(hi1, x));
+        ok = _mm256_or_si256(ok, _mm256_and_si256(_mm256_cmpgt_epi8(x, lo2), _mm256_cmpgt_epi8(hi2, x)));
+        ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(x, dash));
+        if ((unsigned int) _mm256_movemask_epi8(ok) != 0xFFFFFFFFu) return 0;
+    }
+    return nick_chars_ok_sse2(nick + i, len - i);
+}
+
+#endif
+
+int (*scan_for_byte)(const char *s, int len, char byte) = scan_for_byte_scalar;
+void (*fold_irc_case)(char *dst, const char *src, int len) = fold_irc_case_scalar;
+int (*is_valid_nick)(const char *nick, int len) = is_valid_nick_scalar;
+int (*is_valid_channel_name)(const char *name, int len) = is_valid_channel_name_scalar;
+
+scan_level init_scan_kernels(scan_level max_level){
+    // returns the level actually selected
+    scan_level level = SCAN_SCALAR;
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (max_level >= SCAN_SSE2 && __builtin_cpu_supports("sse2")) level = SCAN_SSE2;
+    if (max_level >= SCAN_AVX2 && __builtin_cpu_supports("avx2")) level = SCAN_AVX2;
+#endif
+
+    scan_for_byte = scan_for_byte_scalar;
+    fold_irc_case = fold_irc_case_scalar;
+    is_valid_nick = is_valid_nick_scalar;
+    is_valid_channel_name = is_valid_channel_name_scalar;
+#ifdef HAVE_X86_KERNELS
+    if (level >= SCAN_SSE2){
+        scan_for_byte = scan_for_byte_sse2;
+        fold_irc_case = fold_irc_case_sse2;
+        is_valid_nick = is_valid_nick_sse2;
+        is_valid_channel_name = is_valid_channel_name_sse2;
+    }
+    if (level >= SCAN_AVX2){
+        scan_for_byte = scan_for_byte_avx2;
+        fold_irc_case = fold_irc_case_avx2;
+        is_valid_nick = is_valid_nick_avx2;
+    }
+#endif
+    return level;
+}
@@ -0,0 +1,23 @@
+#include <interfaces/stats.h>
+
+ServerStats server_stats = {0, 0, 0, 0, 0, 1};
+
+void stats_connection_opened(){
+    server_stats.unknown++;
+}
+
+void stats_connection_registered(){
+    // the connection stops being unknown and becomes a user
+    server_stats.unknown--;
+    server_stats.users++;
+    server_stats.clients++;
+}
+
+void stats_connection_closed(int was_registered){
+    if (!was_registered){
+        server_stats.unknown--;
+        return;
+    }
+    server_stats.users--;
+    server_stats.clients--;
+}
@@ -0,0 +1,258 @@
+// Hot upgrade: on SIGUSR2 the server forks and execs its own binary (which may
+// have been replaced on disk) passing it "-U <fd>", where fd is one end of a
+// Unix socket pair. The old process sends the sockets through it with
+// SCM_RIGHTS together with the serialized state, then exits. The new process
+// rebuilds the state and goes on serving the same sockets.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <interfaces/upgrade.h>
+#include <interfaces/stats.h>
+
+#include <log.h>
+
+#define UPGRADE_MAGIC 0x43495243 // "CIRC"
+#define UPGRADE_VERSION 5
+
+static volatile sig_atomic_t upgrade_requested = 0;
+
+static void request_upgrade(int signum){
+    upgrade_requested = 1;
+}
+
+void install_upgrade_handler(){
+    // no SA_RESTART: a blocking accept/recv returns EINTR so that we can act
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_upgrade;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR2, &action, NULL);
+}
+
+int upgrade_was_requested(){
+    int requested = upgrade_requested;
+    upgrade_requested = 0;
+    return requested;
+}
+
+static int write_all(int fd, const void *data, size_t len){
+    const char *p = data;
+    while (len > 0){
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0){
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int read_all(int fd, void *data, size_t len){
+    char *p = data;
+    while (len > 0){
+        ssize_t n = recv(fd, p, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int send_fd(int channel_fd, int fd_to_send){
+    char byte = 0;
+    struct iovec iov = {&byte, 1};
+    char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    memset(control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg -> cmsg_level = SOL_SOCKET;
+    cmsg -> cmsg_type = SCM_RIGHTS;
+    cmsg -> cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd_to_send, sizeof(int));
+    return sendmsg(channel_fd, &msg, MSG_NOSIGNAL) == 1 ? 0 : -1;
+}
+
+static int recv_fd(int channel_fd){
+    char byte;
+    struct iovec iov = {&byte, 1};
+    char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (recvmsg(channel_fd, &msg, 0) != 1) return -1;
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg -> cmsg_type != SCM_RIGHTS) return -1;
+    int fd;
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    return fd;
+}
+
+static int write_string(int fd, const char *string){
+    int len = string ? strlen(string) : 0;
+    if (write_all(fd, &len, sizeof(len)) < 0) return -1;
+    return write_all(fd, string, len);
+}
+
+static char *read_string(int fd){
+    int len;
+    if (read_all(fd, &len, sizeof(len)) < 0 || len < 0 || len > UPGRADE_LINE_LEN) return NULL;
+    char *string = (char *) malloc(len + 1);
+    if (read_all(fd, string, len) < 0){
+        free(string);
+        return NULL;
+    }
+    string[len] = 0;
+    return string;
+}
+
+static int send_state(int channel_fd, UpgradeState *state, User *p_user_head){
+    int header[2] = {UPGRADE_MAGIC, UPGRADE_VERSION};
+    int has_client = state -> client_fd >= 0;
+
+    if (write_all(channel_fd, header, sizeof(header)) < 0) return -1;
+    if (send_fd(channel_fd, state -> listen_fd) < 0) return -1;
+    if (write_all(channel_fd, &server_stats, sizeof(server_stats)) < 0) return -1;
+    if (write_all(channel_fd, &has_client, sizeof(has_client)) < 0) return -1;
+    if (!has_client) return 0;
+
+    if (send_fd(channel_fd, state -> client_fd) < 0) return -1;
+    // only what registration got so far: the new binary replays it to rebuild the state
+    Registration *registration = &state -> registration;
+    if (write_all(channel_fd, &registration -> got_pass, sizeof(int)) < 0) return -1;
+    if (write_all(channel_fd, &registration -> compress, sizeof(int)) < 0) return -1;
+    if (write_string(channel_fd, registration -> nick_name ? registration -> nick_name -> string : NULL) < 0) return -1;
+    if (write_string(channel_fd, registration -> user_name ? registration -> user_name -> string : NULL) < 0) return -1;
+    if (registration -> state == REG_REGISTERED){
+        User *p_user = find_user_by_socket(p_user_head, state -> client_fd);
+        if (!p_user) return -1;
+        if (write_string(channel_fd, p_user -> host_name -> string) < 0) return -1;
+    }
+    if (write_all(channel_fd, &state -> line_len, sizeof(int)) < 0) return -1;
+    if (write_all(channel_fd, state -> line, state -> line_len) < 0) return -1;
+    return write_all(channel_fd, &state -> last_read_char, 1);
+}
+
+void hand_off_to_new_binary(char *argv[], UpgradeState *state, User *p_user_head){
+    // returns only if the upgrade could not be done: the old binary keeps serving
+    int channel[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, channel) < 0){
+        perror("Upgrade: socketpair");
+        return;
+    }
+    // the new binary gets the sockets through the channel, not by inheriting them
+    fcntl(channel[0], F_SETFD, FD_CLOEXEC);
+    fcntl(state -> listen_fd, F_SETFD, FD_CLOEXEC);
+    if (state -> client_fd >= 0) fcntl(state -> client_fd, F_SETFD, FD_CLOEXEC);
+
+    // the arguments are built before forking: the resolver threads may hold the
+    // malloc lock, so the child must not do anything but exec
+    int argc = 0, new_argc = 0;
+    while (argv[argc]) argc++;
+    char **new_argv = (char **) calloc(argc + 3, sizeof(char *));
+    char fd_arg[16];
+    for (int i = 0; i < argc; i++){
+        // a binary that was itself upgraded has the "-U <fd>" it got: only the new one goes
+        if (strcmp(argv[i], "-U") == 0 && i + 1 < argc){
+            i++;
+            continue;
+        }
+        if (strncmp(argv[i], "-U", 2) == 0 && argv[i][2]) continue; // "-U<fd>"
+        new_argv[new_argc++] = argv[i];
+    }
+    snprintf(fd_arg, sizeof(fd_arg), "%d", channel[1]);
+    new_argv[new_argc] = "-U";
+    new_argv[new_argc + 1] = fd_arg;
+
+    pid_t pid = fork();
+    if (pid == 0){
+        execvp(argv[0], new_argv);
+        _exit(1);
+    }
+    free(new_argv);
+    close(channel[1]);
+    if (pid < 0){
+        perror("Upgrade: fork");
+        close(channel[0]);
+        return;
+    }
+
+    if (send_state(channel[0], state, p_user_head) < 0){
+        chilog(ERROR, "Upgrade failed: could not hand off the state, going on serving");
+        close(channel[0]);
+        waitpid(pid, NULL, 0); // the child gets EOF on the channel (or failed to exec) and exits
+        return;
+    }
+    // wait until the new binary confirms it has taken over
+    char ack;
+    if (read_all(channel[0], &ack, 1) < 0){
+        chilog(ERROR, "Upgrade failed: no answer from the new binary, going on serving");
+        close(channel[0]);
+        waitpid(pid, NULL, 0);
+        return;
+    }
+    chilog(INFO, "Upgrade done, handed off to process %d", pid);
+    exit(0);
+}
+
+int resume_from_old_binary(int channel_fd, UpgradeState *state, User *p_user_head){
+    // returns 0 if the state could not be received
+    int header[2], has_client;
+    char *nick_name = NULL, *user_name = NULL, *host_name = NULL;
+
+    memset(state, 0, sizeof(UpgradeState));
+    state -> client_fd = -1;
+    init_registration(&state -> registration);
+    if (read_all(channel_fd, header, sizeof(header)) < 0) return 0;
+    if (header[0] != UPGRADE_MAGIC || header[1] != UPGRADE_VERSION) return 0;
+    if ((state -> listen_fd = recv_fd(channel_fd)) < 0) return 0;
+    if (read_all(channel_fd, &server_stats, sizeof(server_stats)) < 0) return 0;
+    if (read_all(channel_fd, &has_client, sizeof(has_client)) < 0) return 0;
+
+    if (has_client){
+        if ((state -> client_fd = recv_fd(channel_fd)) < 0) return 0;
+        Registration *registration = &state -> registration;
+        if (read_all(channel_fd, &registration -> got_pass, sizeof(int)) < 0) return 0;
+        if (read_all(channel_fd, &registration -> compress, sizeof(int)) < 0) return 0;
+        if (!(nick_name = read_string(channel_fd))) return 0;
+        if (!(user_name = read_string(channel_fd))) return 0;
+        if (*nick_name) set_registration_nick(registration, nick_name);
+        if (*user_name) set_registration_user(registration, user_name);
+        if (registration -> state == REG_REGISTERED){
+            if (!(host_name = read_string(channel_fd))) return 0;
+            create_new_user(state -> client_fd, p_user_head, nick_name, user_name, host_name);
+            free(host_name);
+        }
+        free(nick_name);
+        free(user_name);
+        if (read_all(channel_fd, &state -> line_len, sizeof(int)) < 0) return 0;
+        if (state -> line_len < 0 || state -> line_len > UPGRADE_LINE_LEN) return 0;
+        if (read_all(channel_fd, state -> line, state -> line_len) < 0) return 0;
+        if (read_all(channel_fd, &state -> last_read_char, 1) < 0) return 0;
+    }
+
+    char ack = 1;
+    write_all(channel_fd, &ack, 1);
+    close(channel_fd);
+    return 1;
+}
@@ -21,7 +21,8 @@ void add_next_in_linked_struct(User *p_user, User new_user){
 
 }
 
-User create_new_user(int socket_fd, User *p_user_head, char *nick_name, char *user_name) {
+User create_new_user(int socket_fd, User *p_user_head, const char *nick_name, const char *user_name,
+                     const char *host_name) {
     // represents the users with a linked data structure
 
 
@@ -29,8 +30,9 @@ User create_new_user(int socket_fd, User *p_user_head, char *nick_name, char *us
 
     if (!(p_current_user->nick_name)){
         // first user needs to be created
-        p_user_head -> nick_name = nick_name;
-        p_user_head -> user_name = user_name;
+        p_user_head -> nick_name = intern_string(nick_name);
+        p_user_head -> user_name = intern_string(user_name);
+        p_user_head -> host_name = intern_string(host_name);
         p_user_head -> socket_fd = socket_fd;
         p_user_head -> next = NULL;
         return *p_user_head;
@@ -43,8 +45,9 @@ User create_new_user(int socket_fd, User *p_user_head, char *nick_name, char *us
     p_current_user -> next = (User *) malloc(sizeof(User));
     bzero(p_current_user -> next, sizeof(User));
 
-    (p_current_user -> next) -> nick_name = nick_name;
-    (p_current_user -> next) -> user_name = user_name;
+    (p_current_user -> next) -> nick_name = intern_string(nick_name);
+    (p_current_user -> next) -> user_name = intern_string(user_name);
+    (p_current_user -> next) -> host_name = intern_string(host_name);
     (p_current_user -> next) -> socket_fd = socket_fd;
     (p_current_user -> next) -> next = NULL;
     return *(p_current_user->next);
@@ -58,7 +61,7 @@ void print_all_nicknames(User * p_user_head){
         chilog(INFO,"No User to print");
     } else{
         while(p_current_user){
-            chilog(INFO, "User with nickname: %s\n", p_current_user -> nick_name);
+            chilog(INFO, "User with nickname: %s\n", p_current_user -> nick_name -> string);
             p_current_user = p_current_user -> next;
         }
     }
@@ -68,14 +71,14 @@ User *remove_user_by_nickname(User* p_user_head, char *n_name_to_remove){
     User *p_current_user = p_user_head;
     if (!p_current_user->nick_name) return NULL;
 
-    u_int s_len = strlen(n_name_to_remove);
+    InternedString *target = intern_string(n_name_to_remove);
     User *p_previous_user = (User *) malloc(sizeof(User));
     bzero(p_previous_user, sizeof(User));
 
     while(p_current_user){
         // edge case is removing the first node
 
-        if (strncmp(p_current_user -> nick_name, n_name_to_remove, s_len) == 0){
+        if (interned_equal_nocase(p_current_user -> nick_name, target)){
             if (!p_previous_user->nick_name){
                 // the target nickname is hold by the head
                 p_user_head = p_current_user -> next;
@@ -87,5 +90,45 @@ User *remove_user_by_nickname(User* p_user_head, char *n_name_to_remove){
         p_current_user = p_current_user -> next;
     }
 
+    release_string(target);
     return p_user_head;
 }
+
+User *find_user_by_socket(User *p_user_head, int socket_fd){
+    User *p_current_user = p_user_head;
+    if (!p_current_user->nick_name) return NULL;
+
+    while(p_current_user){
+        if (p_current_user -> socket_fd == socket_fd) return p_current_user;
+        p_current_user = p_current_user -> next;
+    }
+    return NULL;
+}
+
+void remove_user_by_socket(User *p_user_head, int socket_fd){
+    User *p_previous_user = NULL, *p_current_user = p_user_head;
+    if (!p_current_user->nick_name) return;
+
+    while(p_current_user && p_current_user -> socket_fd != socket_fd){
+        p_previous_user = p_current_user;
+        p_current_user = p_current_user -> next;
+    }
+    if (!p_current_user) return;
+
+    release_string(p_current_user -> nick_name);
+    release_string(p_current_user -> user_name);
+    release_string(p_current_user -> host_name);
+    if (p_previous_user){
+        p_previous_user -> next = p_current_user -> next;
+        free(p_current_user);
+        return;
+    }
+    // the head holds the first user itself: the second one (if any) takes its place
+    User *p_next_user = p_current_user -> next;
+    if (p_next_user){
+        *p_user_head = *p_next_user;
+        free(p_next_user);
+    } else{
+        bzero(p_user_head, sizeof(User));
+    }
+}
@@ -91,6 +91,7 @@
 #define ERR_UNKNOWNCOMMAND      "421"
 #define ERR_NOMOTD              "422"
 #define ERR_NONICKNAMEGIVEN     "431"
+#define ERR_ERRONEUSNICKNAME    "432"
 #define ERR_NICKNAMEINUSE       "433"
 #define ERR_USERNOTINCHANNEL    "441"
 #define ERR_NOTONCHANNEL        "442"
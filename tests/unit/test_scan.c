@@ -0,0 +1,75 @@
+// Checks that every SIMD scan kernel gives the same results as the scalar one.
+// Run it with `make unit-tests`.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <interfaces/scan.h>
+
+#define NUM_ROUNDS 20000
+#define MAX_LEN 200
+
+static int failures = 0;
+
+static void check(int condition, const char *what, scan_level level, const char *input, int len){
+    if (condition) return;
+    failures++;
+    printf("FAILED %s (level %d) on \"%.*s\"\n", what, level, len, input);
+}
+
+static void random_string(char *s, int len){
+    // mostly IRC-ish bytes, some of them outside of every valid set
+    const char alphabet[] = "abcXYZ019[]\\^{}|~`_- #&,:\r\n\x07\x80\xff";
+    for (int i = 0; i < len; i++) s[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+}
+
+static void random_valid_nick(char *s, int len){
+    const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789[]\\`_^{|}-";
+    for (int i = 0; i < len; i++) s[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+    if (len > 0) s[0] = 'n';
+}
+
+int main(){
+    char input[MAX_LEN], expected[MAX_LEN], got[MAX_LEN];
+    srand(1);
+
+    for (scan_level wanted = SCAN_SSE2; wanted <= SCAN_AVX2; wanted++){
+        scan_level level = init_scan_kernels(wanted);
+        if (level != wanted){
+            printf("level %d not supported by this CPU, skipped\n", wanted);
+            continue;
+        }
+
+        for (int round = 0; round < NUM_ROUNDS; round++){
+            int len = rand() % MAX_LEN;
+            if (round % 2) random_string(input, len);
+            else random_valid_nick(input, len);
+            char byte = " :\r\n"[rand() % 4];
+
+            init_scan_kernels(SCAN_SCALAR);
+            int expected_index = scan_for_byte(input, len, byte);
+            fold_irc_case(expected, input, len);
+            int expected_nick = is_valid_nick(input, len);
+            int expected_channel = is_valid_channel_name(input, len);
+
+            init_scan_kernels(level);
+            check(scan_for_byte(input, len, byte) == expected_index, "scan_for_byte", level, input, len);
+            fold_irc_case(got, input, len);
+            check(memcmp(got, expected, len) == 0, "fold_irc_case", level, input, len);
+            check(is_valid_nick(input, len) == expected_nick, "is_valid_nick", level, input, len);
+            check(is_valid_channel_name(input, len) == expected_channel, "is_valid_channel_name", level, input, len);
+        }
+    }
+
+    // a few known answers for the scalar versions themselves
+    init_scan_kernels(SCAN_SCALAR);
+    fold_irc_case(got, "NICK[]\\^~", 9);
+    check(memcmp(got, "nick{}|~~", 9) == 0, "fold_irc_case known answer", SCAN_SCALAR, "NICK[]\\^~", 9);
+    check(is_valid_nick("user1", 5) && !is_valid_nick("1user", 5) && !is_valid_nick("us er", 5),
+          "is_valid_nick known answers", SCAN_SCALAR, "", 0);
+    check(is_valid_channel_name("#test", 5) && !is_valid_channel_name("test", 4) && !is_valid_channel_name("#a,b", 4),
+          "is_valid_channel_name known answers", SCAN_SCALAR, "", 0);
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures != 0;
+}